@@ -0,0 +1,54 @@
+#feature MULTI_DRAW
+
+#shader vertex
+#version 330 core
+#ifdef MULTI_DRAW
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in float drawID; //IndirectBatch의 draw ID stream(instance마다, BaseInstance = draw 번호)
+
+//IndirectBatch에 넘기는 per-draw data와 같은 구조(80 byte, 16의 배수)
+struct DrawData
+{
+	mat4 Model;
+	vec4 Color;
+};
+
+#ifdef MULTI_DRAW
+//multi-draw: draw 전체의 data가 배열로 한번에 bind됨
+layout(std430, binding = 0) readonly buffer DrawBlock
+{
+	DrawData u_Draws[];
+};
+#define DRAW u_Draws[int(drawID)]
+#else
+//fallback: draw마다 그 draw의 범위가 bind됨(Shader::SetUniformBlockBinding("DrawBlock", 0))
+layout(std140) uniform DrawBlock
+{
+	DrawData u_Draw;
+};
+#define DRAW u_Draw
+#endif
+
+out vec4 v_Color;
+
+void main()
+{
+	gl_Position = DRAW.Model * vec4(position, 1.0);
+	v_Color = DRAW.Color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};
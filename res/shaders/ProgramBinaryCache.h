@@ -0,0 +1,220 @@
+
+// ProgramBinaryCache.h
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+//링크가 끝난 셰이더 프로그램을 glGetProgramBinary로 받아 디스크에 저장해두고, 다음 실행때는 glProgramBinary로 바로 올려서 컴파일/링크를 건너뜀
+//파일 이름은 소스(+define) 해시, 파일 헤더에는 드라이버(vendor/renderer/version) 해시를 함께 저장해서 드라이버가 바뀌면 다시 컴파일하고 덮어씀
+
+struct ProgramBinaryCacheStats
+{
+	unsigned int Hits = 0;
+	unsigned int Misses = 0; //캐시 파일이 없거나, 아래 Rejected 처럼 쓸 수 없어서 다시 컴파일한 경우
+	unsigned int Rejected = 0; //드라이버 불일치, 손상된 blob, glProgramBinary 실패
+	double TimeSavedMs = 0.0; //저장된 컴파일 시간 - 로드에 걸린 시간의 합
+};
+
+class ProgramBinaryCache
+{
+private:
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint64_t DriverHash;
+		uint64_t Checksum; //blob 데이터의 해시, 손상 여부 확인용
+		uint32_t Format; //glGetProgramBinary가 알려준 binary format
+		uint32_t Length;
+		double CompileMs; //처음 컴파일할 때 걸린 시간, hit시 절약한 시간 계산에 사용(0이면 모름)
+	};
+
+	static constexpr uint32_t s_Magic = 0x50424331; // "PBC1"
+	static constexpr uint32_t s_Version = 1;
+
+	std::string m_Directory;
+	uint64_t m_DriverHash;
+	bool m_Supported;
+	ProgramBinaryCacheStats m_Stats;
+public:
+	ProgramBinaryCache(const std::string& directory); //GL context 생성(glewInit) 이후에 만들어야 함
+
+	static constexpr uint64_t s_HashSeed = 0xcbf29ce484222325ull;
+	static uint64_t Hash(std::string_view data, uint64_t seed = s_HashSeed); //FNV-1a 64bit
+
+	unsigned int Load(uint64_t key); //성공하면 링크된 program id, 실패하면 0
+	void Store(uint64_t key, unsigned int program, double compileMs); //compileMs를 잴 수 없었으면 0, hit되어도 TimeSavedMs에 넣지 않음
+
+	inline bool IsSupported() const { return m_Supported; }
+	inline const ProgramBinaryCacheStats& GetStats() const { return m_Stats; }
+private:
+	std::string GetPath(uint64_t key) const;
+	void Reject(const std::string& path, const char* reason);
+};
+
+// ProgramBinaryCache.cpp
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+	:m_Directory{ directory }, m_DriverHash{ 0 }, m_Supported{ false }
+{
+	int formats = 0;
+	if (GLEW_ARB_get_program_binary) //GL 4.1 core
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	m_Supported = formats > 0;
+	if (!m_Supported)
+	{
+		std::cout << "Warning: program binary를 지원하지 않는 드라이버, 캐시를 사용하지 않음\n";
+		return;
+	}
+
+	//드라이버가 바뀌면 binary를 쓸 수 없으므로 드라이버 문자열을 해시해둠
+	const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	m_DriverHash = s_HashSeed;
+	for (GLenum name : strings)
+	{
+		const char* value = (const char*)glGetString(name);
+		m_DriverHash = Hash(value ? value : "", m_DriverHash);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_Directory, error);
+}
+
+uint64_t ProgramBinaryCache::Hash(std::string_view data, uint64_t seed)
+{
+	uint64_t hash = seed;
+	for (unsigned char c : data)
+	{
+		hash ^= c;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+std::string ProgramBinaryCache::GetPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return m_Directory + "/" + name;
+}
+
+void ProgramBinaryCache::Reject(const std::string& path, const char* reason)
+{
+	std::cout << "Warning: program binary '" << path << "' 사용 불가(" << reason << "), 다시 컴파일함\n";
+	m_Stats.Rejected++;
+	m_Stats.Misses++;
+}
+
+unsigned int ProgramBinaryCache::Load(uint64_t key)
+{
+	if (!m_Supported)
+		return 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::string path = GetPath(key);
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream)
+	{
+		m_Stats.Misses++;
+		return 0;
+	}
+
+	Header header;
+	if (!stream.read((char*)&header, sizeof(header)) || header.Magic != s_Magic || header.Version != s_Version || header.Key != key)
+	{
+		Reject(path, "잘못된 헤더");
+		return 0;
+	}
+	if (header.DriverHash != m_DriverHash)
+	{
+		Reject(path, "드라이버 불일치");
+		return 0;
+	}
+
+	//헤더의 길이를 믿고 할당하기 전에 실제 파일 크기와 맞는지 확인(잘리거나 손상된 파일이 수 GB를 할당하지 않도록)
+	std::error_code error;
+	uintmax_t fileSize = std::filesystem::file_size(path, error);
+	if (error || header.Length == 0 || header.Length > fileSize - sizeof(header))
+	{
+		Reject(path, "잘못된 blob 길이");
+		return 0;
+	}
+
+	std::vector<char> blob(header.Length);
+	if (!stream.read(blob.data(), header.Length) || Hash({ blob.data(), blob.size() }) != header.Checksum)
+	{
+		Reject(path, "손상된 blob");
+		return 0;
+	}
+
+	unsigned int program = glCreateProgram();
+	glProgramBinary(program, header.Format, blob.data(), header.Length);
+
+	int result;
+	glGetProgramiv(program, GL_LINK_STATUS, &result); //드라이버가 binary를 거부하면 링크 실패로 나옴
+	if (result == GL_FALSE)
+	{
+		glDeleteProgram(program);
+		Reject(path, "glProgramBinary 실패");
+		return 0;
+	}
+
+	double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_Stats.Hits++;
+	if (header.CompileMs > loadMs) //CompileMs가 0(잴 수 없었던 Async 빌드)이면 넣지 않음
+		m_Stats.TimeSavedMs += header.CompileMs - loadMs;
+
+	return program;
+}
+
+void ProgramBinaryCache::Store(uint64_t key, unsigned int program, double compileMs)
+{
+	if (!m_Supported)
+		return;
+
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> blob(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, blob.data());
+
+	Header header;
+	header.Magic = s_Magic;
+	header.Version = s_Version;
+	header.Key = key;
+	header.DriverHash = m_DriverHash;
+	header.Checksum = Hash({ blob.data(), (size_t)length });
+	header.Format = format;
+	header.Length = (uint32_t)length;
+	header.CompileMs = compileMs;
+
+	//쓰는 도중에 종료되어도 반쯤 쓰인 파일을 읽지 않도록 임시 파일에 쓴 뒤 rename
+	std::string path = GetPath(key);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+		stream.write((const char*)&header, sizeof(header));
+		stream.write(blob.data(), length);
+		if (!stream)
+		{
+			std::cout << "Warning: program binary '" << path << "' 저장 실패\n";
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+}
@@ -0,0 +1,88 @@
+#feature TEXTURE_SLOTS_32
+
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position; //화면 pixel 좌표(왼쪽 위가 원점)
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in float texIndex; //QuadBatch의 texture slot
+
+uniform vec4 u_ScreenTransform; //xy: 2 / 화면 크기(y는 음수), zw: offset. QuadBatch::SetViewport가 설정
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TexIndex;
+
+void main()
+{
+	gl_Position = vec4(position * u_ScreenTransform.xy + u_ScreenTransform.zw, 0.0, 1.0);
+	v_TexCoord = texCoord;
+	v_Color = color;
+	v_TexIndex = int(texIndex + 0.5);
+};
+
+#shader fragment
+#version 330 core
+
+#ifdef TEXTURE_SLOTS_32
+#define TEXTURE_SLOTS 32
+#else
+#define TEXTURE_SLOTS 16
+#endif
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TexIndex;
+
+uniform sampler2D u_Textures[TEXTURE_SLOTS]; //slot i = texture unit i, slot 0은 흰색(색만 있는 quad)
+
+//GLSL 330에서는 sampler 배열을 상수 index로만 읽을 수 있으므로 switch로 고름
+vec4 SampleSlot(int slot, vec2 uv)
+{
+	switch (slot)
+	{
+		case 0: return texture(u_Textures[0], uv);
+		case 1: return texture(u_Textures[1], uv);
+		case 2: return texture(u_Textures[2], uv);
+		case 3: return texture(u_Textures[3], uv);
+		case 4: return texture(u_Textures[4], uv);
+		case 5: return texture(u_Textures[5], uv);
+		case 6: return texture(u_Textures[6], uv);
+		case 7: return texture(u_Textures[7], uv);
+		case 8: return texture(u_Textures[8], uv);
+		case 9: return texture(u_Textures[9], uv);
+		case 10: return texture(u_Textures[10], uv);
+		case 11: return texture(u_Textures[11], uv);
+		case 12: return texture(u_Textures[12], uv);
+		case 13: return texture(u_Textures[13], uv);
+		case 14: return texture(u_Textures[14], uv);
+		case 15: return texture(u_Textures[15], uv);
+#ifdef TEXTURE_SLOTS_32
+		case 16: return texture(u_Textures[16], uv);
+		case 17: return texture(u_Textures[17], uv);
+		case 18: return texture(u_Textures[18], uv);
+		case 19: return texture(u_Textures[19], uv);
+		case 20: return texture(u_Textures[20], uv);
+		case 21: return texture(u_Textures[21], uv);
+		case 22: return texture(u_Textures[22], uv);
+		case 23: return texture(u_Textures[23], uv);
+		case 24: return texture(u_Textures[24], uv);
+		case 25: return texture(u_Textures[25], uv);
+		case 26: return texture(u_Textures[26], uv);
+		case 27: return texture(u_Textures[27], uv);
+		case 28: return texture(u_Textures[28], uv);
+		case 29: return texture(u_Textures[29], uv);
+		case 30: return texture(u_Textures[30], uv);
+		case 31: return texture(u_Textures[31], uv);
+#endif
+	}
+	return vec4(1.0);
+}
+
+void main()
+{
+	color = SampleSlot(v_TexIndex, v_TexCoord) * v_Color;
+};
@@ -6,168 +6,749 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 // #include "Renderer.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderVariantManifest.h"
+#include "ShaderSource.h"
+#include "src/GLState.h"
 
-struct ShaderProgramSource
+//uniform 이름의 FNV-1a 해시. 문자열 리터럴에서 암시적으로 변환되고, constexpr 변수에 담아두면 컴파일 타임에 계산됨
+struct UniformID
 {
-	std::string VertexSource;
-	std::string FragSource;
+	uint32_t Hash;
+
+	constexpr UniformID(std::string_view name) : Hash{ HashName(name) } {}
+	constexpr UniformID(const char* name) : UniformID(std::string_view(name)) {}
+	UniformID(const std::string& name) : UniformID(std::string_view(name)) {}
+
+	static constexpr uint32_t HashName(std::string_view name)
+	{
+		uint32_t hash = 0x811c9dc5u;
+		for (char c : name)
+		{
+			hash ^= (unsigned char)c;
+			hash *= 0x01000193u;
+		}
+		return hash;
+	}
+};
+
+constexpr UniformID operator""_u(const char* name, size_t length) { return UniformID(std::string_view(name, length)); }
+
+//링크 후 glGetActiveUniform으로 얻어온 uniform 정보. Shader 안의 배열 index가 곧 handle
+struct UniformInfo
+{
+	uint32_t Hash;
+	int Location;
+	unsigned int Type; //GL_FLOAT_VEC4 등
+	int Count; //배열이면 원소 수
+	std::string Name;
+	uint32_t ShadowOffset; //ShaderProgram::UniformShadow 안에서 마지막으로 올린 값의 위치
+	uint32_t ShadowSize;
+	bool ShadowValid; //한번이라도 값을 올린 적이 있는지
+};
+
+//같은 값을 다시 올리는 glUniform* 호출을 얼마나 건너뛰었는지. 매 frame ResetUniformStats()로 초기화
+struct UniformUploadStats
+{
+	unsigned int Issued = 0;
+	unsigned int Elided = 0;
+};
+
+//링크된(또는 빌드 중인) GL 프로그램 하나와 그 프로그램의 uniform 정보
+struct ShaderProgram
+{
+	unsigned int RendererID = 0;
+	bool Pending = false; //컴파일/링크 결과를 아직 확인하지 않음
+	bool Linked = false;
+	std::vector<unsigned int> PendingStages; //결과 로그를 얻기 위해 확인 전까지 들고 있는 각 stage의 셰이더 id
+	uint64_t CacheKey = 0;
+	bool Async = false; //제출만 하고 나중에 결과를 확인함. 확인이 늦어진 frame이 섞이므로 완료 시점을 직접 본 경우에만 시간을 잼
+	bool CompletionSeen = false; //GL_COMPLETION_STATUS로 완료를 확인함(BuildEnd가 유효)
+	std::chrono::steady_clock::time_point BuildStart;
+	std::chrono::steady_clock::time_point BuildEnd;
+	double CompileMs = 0.0; //제출부터 링크 완료까지 걸린 시간(캐시에서 읽었거나, 완료 시점을 모르는 Async 빌드면 0)
+	std::vector<std::string> SourceFiles; //에러 메시지의 "#line" 파일 번호 -> 경로
+
+	std::vector<UniformInfo> Uniforms; //Hash 순으로 정렬
+	std::vector<uint32_t> MissingUniforms; //없는 uniform 경고를 한번만 출력하기 위함
+	std::vector<unsigned char> UniformShadow; //각 uniform에 마지막으로 올린 값의 CPU 사본
+
+	ShaderProgram() = default;
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+	~ShaderProgram()
+	{
+		for (unsigned int id : PendingStages)
+			glDeleteShader(id);
+		GLState::OnDeleteProgram(RendererID);
+		glDeleteProgram(RendererID);
+	}
+};
+
+//Reload 후 UpdateReload()의 결과
+enum class ShaderReload
+{
+	None, Pending, Swapped, Failed
+};
+
+//Sync는 생성자에서 링크까지 기다림. Async는 컴파일/링크 명령만 제출하고 바로 반환하므로 IsReady()로 확인하며 다른 로딩 작업을 진행할 수 있음
+enum class ShaderBuild
+{
+	Sync, Async
 };
 
 class Shader
 {
 private:
 	std::string m_FilePath;
-	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::vector<std::string> m_Dependencies; //이 셰이더를 만드는데 읽은 파일들(hot reload 감시 대상)
+	ShaderProgramSource m_Source; //variant를 나중에 컴파일하기 위해 파싱 결과를 들고 있음
+	std::unordered_map<uint32_t, std::unique_ptr<ShaderProgram>> m_Variants; //feature bitmask -> 프로그램
+	ShaderProgram* m_Program; //현재 선택된 variant
+	uint32_t m_Variant;
+	std::unique_ptr<ShaderProgram> m_Reload; //hot reload로 빌드 중인 새 프로그램, 성공하면 현재 variant와 교체
+	ShaderProgramSource m_ReloadSource;
+
+	inline static ProgramBinaryCache* s_ProgramCache = nullptr;
+	inline static ShaderVariantManifest* s_VariantManifest = nullptr;
+	inline static bool s_ParallelCompile = false;
+	inline static UniformUploadStats s_UniformStats;
+	inline static ShaderSourceCache s_SourceCache;
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, ShaderBuild build = ShaderBuild::Sync);
+	Shader(const std::string& filepath, const ShaderProgramSource& source, uint32_t variant = 0, ShaderBuild build = ShaderBuild::Sync); //이미 파싱한 소스와 처음 사용할 variant로 생성
 	~Shader();
 
+	//모든 Shader가 공유하는 program binary 캐시, nullptr이면 매번 소스에서 컴파일
+	static void SetProgramCache(ProgramBinaryCache* cache) { s_ProgramCache = cache; }
+	//설정되어 있으면 새로 사용한 variant를 기록하고, Shader 생성 시 기록된 variant를 미리 빌드 제출함
+	static void SetVariantManifest(ShaderVariantManifest* manifest) { s_VariantManifest = manifest; }
+	//KHR_parallel_shader_compile이 있으면 드라이버 컴파일 스레드를 켜고, 완료 여부를 블로킹 없이 확인할 수 있게 함
+	static bool EnableParallelCompile(unsigned int threads = 0xFFFFFFFF);
+
+	bool IsReady(); //블로킹 없이 빌드가 끝났는지 확인(끝났으면 결과 확인까지 수행)
+	bool Wait(); //빌드가 끝날때까지 기다리고 링크 성공 여부를 반환
+	inline bool IsLinked() const { return m_Program->Linked; }
+	inline unsigned int GetRendererID() const { return m_Program->RendererID; }
+	inline double GetCompileTime() const { return m_Program->CompileMs; } //0이면 잴 수 없었음(캐시 hit, 완료 시점을 모르는 Async 빌드)
+	inline const ShaderProgramSource& GetSource() const { return m_Source; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+	inline const std::vector<std::string>& GetDependencies() const { return m_Dependencies; }
+
+	//permutation: .shader 파일의 "#feature 이름" 마다 bit 하나. 선택한 bit의 "#define 이름 1"이 #version 다음에 들어감
+	uint32_t GetFeatureMask(std::string_view feature) const; //없는 feature면 0
+	void SetVariant(uint32_t mask); //처음 사용하는 variant면 이때 컴파일(같은 define 조합은 한번만 컴파일). Bind 전에 호출
+	inline uint32_t GetVariant() const { return m_Variant; }
+	inline size_t GetVariantCount() const { return m_Variants.size(); }
+
+	//hot reload: 새 소스로 빌드를 제출하고, frame 경계에서 UpdateReload()를 불러 빌드가 끝났으면 교체.
+	//컴파일/링크에 실패하면 기존 프로그램을 그대로 사용. 교체 후에는 GetUniformIndex로 얻은 index를 다시 얻어야 함
+	void Reload(const ShaderProgramSource& source);
+	ShaderReload UpdateReload();
+
 	void Bind() const; //함수는 glUseProgram()이지만, 앞서 설명한 것과 같이 바인딩("작업 상태로 만듬")과 같은 역할이기 때문에 Bind()로 통일
 	void Unbind() const;
 
+	//uniform handle. 프로그램이 살아있는 동안 변하지 않으므로 한번 얻어두고 계속 사용하면 됨, 없으면 -1
+	int GetUniformIndex(UniformID id);
+	int GetUniformLocation(UniformID id);
+	inline const std::vector<UniformInfo>& GetUniforms() const { return m_Program->Uniforms; }
+
 	//Set Uniforms
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniform1f(const std::string& name, float value);
-private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragShader);
+	void SetUniform4f(int index, float v0, float v1, float v2, float v3);
+	void SetUniform1f(int index, float value);
+	void SetUniform4f(UniformID id, float v0, float v1, float v2, float v3) { SetUniform4f(GetUniformIndex(id), v0, v1, v2, v3); }
+	void SetUniform1f(UniformID id, float value) { SetUniform1f(GetUniformIndex(id), value); }
+
+	//셰이더의 uniform block을 binding point에 연결. 이후 UniformRingBuffer::BindRange로 같은 binding point에 buffer 범위를 바인딩
+	bool SetUniformBlockBinding(const std::string& blockName, unsigned int bindingPoint);
+
+	static const UniformUploadStats& GetUniformStats() { return s_UniformStats; }
+	static void ResetUniformStats() { s_UniformStats = {}; }
 
-	int GetUniformLocation(const std::string& name);
+	static ShaderProgramSource ParseShader(const std::string& filepath);
+	static ShaderSourceCache& GetSourceCache() { return s_SourceCache; }
+private:
+	unsigned int CompileShader(unsigned int type, std::string_view source, std::string_view defines, int firstLine);
+	std::unique_ptr<ShaderProgram> CreateShader(const ShaderProgramSource& source, uint32_t mask, ShaderBuild build);
+	static uint32_t NormalizeMask(const ShaderProgramSource& source, uint32_t mask);
+	static std::string MakeDefines(const ShaderProgramSource& source, uint32_t mask);
+	static bool IsBuildComplete(ShaderProgram& program);
+	bool FinishBuild(ShaderProgram& program);
+	static const char* GetStageName(int type);
+	static void ReflectUniforms(ShaderProgram& program);
+	static void CopyUniformValues(const ShaderProgram& from, ShaderProgram& to);
+	static void UploadUniform(const UniformInfo& uniform, const void* data);
+	bool UpdateShadow(int index, const void* data, uint32_t size);
+	static uint32_t GetUniformTypeSize(unsigned int type);
 };
 
 // Shader.cpp
 
-Shader::Shader(const std::string & filepath)
-	:m_FilePath{ filepath }, m_RendererID{ 0 }
+Shader::Shader(const std::string & filepath, ShaderBuild build)
+	:Shader(filepath, ParseShader(filepath), 0, build)
+{
+}
+
+Shader::Shader(const std::string& filepath, const ShaderProgramSource& source, uint32_t variant, ShaderBuild build)
+	:m_FilePath{ filepath }, m_Source{ source }, m_Program{ nullptr }, m_Variant{ NormalizeMask(source, variant) }
 {
-	ShaderProgramSource source = ParseShader(filepath);
+	m_Dependencies = m_Source.Files.empty() ? std::vector<std::string>{ filepath } : m_Source.Files;
+
+	m_Variants[m_Variant] = CreateShader(m_Source, m_Variant, build);
+	m_Program = m_Variants[m_Variant].get();
+
+	//Sync면 manifest variant를 제출하기 전에 기다려서, 그 제출 시간이 CompileMs에 섞이지 않게 함
+	if (build == ShaderBuild::Sync)
+		Wait();
 
-	m_RendererID = CreateShader(source.VertexSource, source.FragSource);
+	//지난 실행에서 사용된 variant들을 미리 제출해두면 처음 SetVariant할 때 멈추지 않음
+	if (s_VariantManifest)
+	{
+		for (const auto& features : s_VariantManifest->GetVariants(m_FilePath))
+		{
+			uint32_t mask = 0;
+			for (const std::string& feature : features)
+				mask |= GetFeatureMask(feature);
+			if (m_Variants.find(mask) == m_Variants.end())
+				m_Variants[mask] = CreateShader(m_Source, mask, ShaderBuild::Async);
+		}
+	}
 }
 
 Shader::~Shader()
 {
-	glDeleteProgram(m_RendererID);
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+bool Shader::EnableParallelCompile(unsigned int threads)
 {
-	std::ifstream stream(filepath);
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(threads); //0xFFFFFFFF면 드라이버가 정한 최대 스레드 수
+		s_ParallelCompile = true;
+	}
+	return s_ParallelCompile;
+}
 
-	enum class ShaderType
+bool Shader::IsBuildComplete(ShaderProgram& program)
+{
+	if (!program.Pending)
+		return true;
+
+	//확장이 없으면 GL_COMPLETION_STATUS를 물어볼 수 없으므로 끝났다고 보고 기다림
+	if (s_ParallelCompile)
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
-	};
+		int completed;
+		glGetProgramiv(program.RendererID, GL_COMPLETION_STATUS_KHR, &completed);
+		if (completed == GL_TRUE && !program.CompletionSeen)
+		{
+			program.BuildEnd = std::chrono::steady_clock::now(); //처음 완료를 본 시점, poll 간격 이상은 늦지 않음
+			program.CompletionSeen = true;
+		}
+		return completed == GL_TRUE;
+	}
+	return true;
+}
+
+bool Shader::IsReady()
+{
+	if (!IsBuildComplete(*m_Program))
+		return false;
+
+	Wait();
+	return true;
+}
+
+bool Shader::Wait()
+{
+	if (m_Program->Pending)
+		FinishBuild(*m_Program);
+	return m_Program->Linked;
+}
 
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
-	while (getline(stream, line))
+uint32_t Shader::NormalizeMask(const ShaderProgramSource& source, uint32_t mask)
+{
+	//선언되지 않은 bit는 무시해서 같은 define 조합이 같은 variant가 되도록 함
+	size_t count = source.Features.size();
+	return count >= 32 ? mask : mask & ((1u << count) - 1);
+}
+
+std::string Shader::MakeDefines(const ShaderProgramSource& source, uint32_t mask)
+{
+	std::string defines;
+	for (size_t i = 0; i < source.Features.size() && i < 32; i++)
 	{
-		if (line.find("#shader") != std::string::npos)
+		if (mask & (1u << i))
 		{
-			if (line.find("vertex") != std::string::npos) //vertex 셰이더 섹션
-			{
-				type = ShaderType::VERTEX;
-			}
-			else if (line.find("fragment") != std::string::npos) //fragment 셰이더 섹션
-			{
-				type = ShaderType::FRAGMENT;
-			}
+			defines += "#define ";
+			defines += source.Features[i];
+			defines += " 1\n";
 		}
-		else
+	}
+	return defines;
+}
+
+uint32_t Shader::GetFeatureMask(std::string_view feature) const
+{
+	for (size_t i = 0; i < m_Source.Features.size() && i < 32; i++)
+	{
+		if (m_Source.Features[i] == feature)
+			return 1u << i;
+	}
+	return 0;
+}
+
+void Shader::SetVariant(uint32_t mask)
+{
+	mask = NormalizeMask(m_Source, mask);
+	if (mask == m_Variant)
+		return;
+
+	auto it = m_Variants.find(mask);
+	if (it == m_Variants.end())
+	{
+		it = m_Variants.emplace(mask, CreateShader(m_Source, mask, ShaderBuild::Sync)).first;
+		if (s_VariantManifest)
 		{
-			ss[(int)type] << line << '\n'; //코드를 stringstream에 삽입
+			std::vector<std::string> features;
+			for (size_t i = 0; i < m_Source.Features.size() && i < 32; i++)
+			{
+				if (mask & (1u << i))
+					features.emplace_back(m_Source.Features[i]);
+			}
+			s_VariantManifest->Record(m_FilePath, features);
 		}
 	}
 
-	return { ss[0].str(), ss[1].str() };
+	m_Variant = mask;
+	m_Program = it->second.get();
+	Wait(); //곧 사용할 것이므로 빌드 결과를 확인
 }
 
+void Shader::Reload(const ShaderProgramSource& source)
+{
+	//현재 variant만 다시 빌드하고, 나머지 variant는 교체 후 다시 사용될 때 새 소스로 컴파일
+	m_ReloadSource = source;
+	m_Reload = CreateShader(source, NormalizeMask(source, m_Variant), ShaderBuild::Async); //이전 reload가 진행 중이었다면 버려짐
+}
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+ShaderReload Shader::UpdateReload()
 {
-	unsigned int id = glCreateShader(type); //셰이더 객체 생성(마찬가지)
-	const char* src = source.c_str();
-	glShaderSource(id, 1, &src, nullptr); // 셰이더의 소스 코드 명시
-	glCompileShader(id); // id에 해당하는 셰이더 컴파일
+	if (!m_Reload)
+		return ShaderReload::None;
+	if (!IsBuildComplete(*m_Reload))
+		return ShaderReload::Pending;
+
+	if (m_Reload->Pending)
+		FinishBuild(*m_Reload);
+	if (!m_Reload->Linked)
+	{
+		std::cout << "셰이더 리로드 실패, 기존 프로그램을 유지함: " << m_FilePath << std::endl;
+		m_Reload.reset();
+		return ShaderReload::Failed;
+	}
 
-	// Error Handling(없으면 셰이더 프로그래밍할때 괴롭다...)
-	int result;
-	glGetShaderiv(id, GL_COMPILE_STATUS, &result); //셰이더 프로그램으로부터 컴파일 결과(log)를 얻어옴
-	if (result == GL_FALSE) //컴파일에 실패한 경우
+	//한번만 설정하고 마는 uniform도 있으므로, 이름/타입이 같은 uniform은 기존 값을 새 프로그램에 옮겨줌
+	CopyUniformValues(*m_Program, *m_Reload);
+
+	m_Source = std::move(m_ReloadSource);
+	if (!m_Source.Files.empty())
+		m_Dependencies = m_Source.Files;
+	m_Variant = NormalizeMask(m_Source, m_Variant);
+	m_Variants.clear();
+	m_Program = (m_Variants[m_Variant] = std::move(m_Reload)).get();
+	return ShaderReload::Swapped;
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+{
+	//파일 읽기/#include 펼치기는 ShaderSourceCache가 하고, 파일이 바뀌지 않았으면 이전 결과를 그대로 돌려줌
+	return s_SourceCache.Parse(filepath);
+}
+
+
+unsigned int Shader::CompileShader(unsigned int type, std::string_view source, std::string_view defines, int firstLine)
+{
+	//#version은 맨 앞에 있어야 하므로 define은 #version 줄 바로 다음에 넣음. 소스를 복사하지 않고 여러 문자열로 나눠서 전달
+	//define 뒤에 "#line"을 넣어서 에러 메시지의 줄 번호가 .shader 파일의 줄 번호와 같게 함
+	std::string_view parts[3] = { {}, {}, source };
+	size_t version = source.find("#version");
+	if (version != std::string_view::npos)
 	{
-		int length;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length); //log의 길이를 얻어옴
-		char* message = (char*)alloca(length * sizeof(char)); //stack에 동적할당
-		glGetShaderInfoLog(id, length, &length, message); //길이만큼 log를 얻어옴
-		std::cout << "셰이더 컴파일 실패! " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
-		std::cout << message << std::endl;
-		glDeleteShader(id); //컴파일 실패한 경우 셰이더 삭제
-		return 0;
+		size_t lineEnd = source.find('\n', version);
+		lineEnd = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+		parts[0] = source.substr(0, lineEnd);
+		parts[2] = source.substr(lineEnd);
+	}
+	std::string preamble(defines);
+	preamble += "#line " + std::to_string(firstLine + (int)std::count(parts[0].begin(), parts[0].end(), '\n')) + " 0\n";
+	parts[1] = preamble;
+
+	const char* strings[3];
+	int lengths[3];
+	int count = 0;
+	for (std::string_view part : parts)
+	{
+		if (part.empty())
+			continue;
+		strings[count] = part.data();
+		lengths[count] = (int)part.size(); //view는 null로 끝나지 않으므로 길이를 함께 전달
+		count++;
 	}
 
+	unsigned int id = glCreateShader(type); //셰이더 객체 생성(마찬가지)
+	glShaderSource(id, count, strings, lengths); // 셰이더의 소스 코드 명시
+	glCompileShader(id); // id에 해당하는 셰이더 컴파일
+
+	//여기서 GL_COMPILE_STATUS를 물어보면 드라이버가 컴파일이 끝날때까지 멈추므로, 결과 확인은 링크 후 FinishBuild()에서 한번에 함
 	return id;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragShader)
+std::unique_ptr<ShaderProgram> Shader::CreateShader(const ShaderProgramSource& source, uint32_t mask, ShaderBuild build)
 {
+	auto result = std::make_unique<ShaderProgram>();
+	std::string defines = MakeDefines(source, mask);
+
+	//compute 섹션이 있으면 compute 프로그램, 아니면 vertex/fragment(+geometry) 프로그램
+	struct Stage { unsigned int Type; std::string_view Source; int Line; };
+	std::vector<Stage> stages;
+	if (!source.ComputeSource.empty())
+		stages.push_back({ GL_COMPUTE_SHADER, source.ComputeSource, source.ComputeLine });
+	else
+	{
+		stages.push_back({ GL_VERTEX_SHADER, source.VertexSource, source.VertexLine });
+		if (!source.GeometrySource.empty())
+			stages.push_back({ GL_GEOMETRY_SHADER, source.GeometrySource, source.GeometryLine });
+		stages.push_back({ GL_FRAGMENT_SHADER, source.FragSource, source.FragLine });
+	}
+
+	//캐시에 같은 소스로 링크된 binary가 있으면 컴파일을 건너뜀
+	if (s_ProgramCache)
+	{
+		result->CacheKey = ProgramBinaryCache::Hash(defines);
+		for (const auto& stage : stages)
+			result->CacheKey = ProgramBinaryCache::Hash(stage.Source, ProgramBinaryCache::Hash({ (const char*)&stage.Type, sizeof(stage.Type) }, result->CacheKey));
+		if (unsigned int program = s_ProgramCache->Load(result->CacheKey))
+		{
+			result->RendererID = program;
+			result->Linked = true;
+			ReflectUniforms(*result);
+			return result;
+		}
+	}
+
+	result->Async = build == ShaderBuild::Async;
+	result->BuildStart = std::chrono::steady_clock::now();
+	if (source.Files.size() > 1)
+		result->SourceFiles = source.Files;
+
 	unsigned int program = glCreateProgram(); //셰이더 프로그램 객체 생성(int에 저장되는 것은 id)
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragShader);
+	if (s_ProgramCache)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); //링크 전에 설정해야 binary를 얻어올 수 있음
+
+	result->RendererID = program;
 
 	//컴파일된 셰이더 코드를 program에 추가하고 링크
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
+	for (const auto& stage : stages)
+	{
+		unsigned int id = CompileShader(stage.Type, stage.Source, defines, stage.Line);
+		glAttachShader(program, id);
+		result->PendingStages.push_back(id);
+	}
 	glLinkProgram(program);
-	glValidateProgram(program);
 
-	//셰이더 프로그램을 생성했으므로 vs, fs 개별 프로그램은 더이상 필요 없음
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+	//링크 결과도 바로 확인하지 않음. 각 stage는 결과 로그를 얻기 위해 FinishBuild()까지 남겨둠
+	result->Pending = true;
 
-	return program;
+	return result;
+}
+
+const char* Shader::GetStageName(int type)
+{
+	switch (type)
+	{
+		case GL_VERTEX_SHADER: return "vertex";
+		case GL_FRAGMENT_SHADER: return "fragment";
+		case GL_GEOMETRY_SHADER: return "geometry";
+		case GL_COMPUTE_SHADER: return "compute";
+	}
+	return "unknown";
+}
+
+bool Shader::FinishBuild(ShaderProgram& program)
+{
+	program.Pending = false;
+	program.Linked = false;
+
+	// Error Handling(없으면 셰이더 프로그래밍할때 괴롭다...)
+	bool compiled = true;
+	for (unsigned int id : program.PendingStages)
+	{
+		int result;
+		glGetShaderiv(id, GL_COMPILE_STATUS, &result); //셰이더 프로그램으로부터 컴파일 결과(log)를 얻어옴
+		if (result == GL_FALSE) //컴파일에 실패한 경우
+		{
+			int type;
+			glGetShaderiv(id, GL_SHADER_TYPE, &type);
+			int length;
+			glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length); //log의 길이를 얻어옴
+			char* message = (char*)alloca(length * sizeof(char)); //stack에 동적할당
+			glGetShaderInfoLog(id, length, &length, message); //길이만큼 log를 얻어옴
+			std::cout << "셰이더 컴파일 실패! " << GetStageName(type) << std::endl;
+			for (size_t i = 0; i < program.SourceFiles.size(); i++) //include가 있으면 로그의 파일 번호가 어떤 파일인지 같이 출력
+				std::cout << "  " << i << ": " << program.SourceFiles[i] << std::endl;
+			std::cout << message << std::endl;
+			compiled = false;
+		}
+
+		//셰이더 프로그램을 생성했으므로 vs, fs 개별 프로그램은 더이상 필요 없음
+		glDetachShader(program.RendererID, id);
+		glDeleteShader(id);
+	}
+	program.PendingStages.clear();
+	program.SourceFiles.clear();
+
+	if (!compiled)
+		return false;
+
+	int linked;
+	glGetProgramiv(program.RendererID, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		int length;
+		glGetProgramiv(program.RendererID, GL_INFO_LOG_LENGTH, &length);
+		char* message = (char*)alloca(length * sizeof(char));
+		glGetProgramInfoLog(program.RendererID, length, &length, message);
+		std::cout << "셰이더 링크 실패! " << m_FilePath << std::endl;
+		std::cout << message << std::endl;
+		return false;
+	}
+
+	//glValidateProgram은 현재 바인딩된 상태(텍스처 등)에 대해 검사하는 것이므로 생성 시점에는 하지 않음
+
+	//Sync는 제출 직후 기다렸으므로 지금까지가 빌드 시간. Async는 다른 작업을 한 frame들이 섞이므로 완료를 본 시점이 있을 때만 사용하고,
+	//없으면 0으로 두어 캐시/라이브러리의 절약 시간 통계에서 빠지게 함(binary는 그대로 저장)
+	if (!program.Async)
+		program.CompileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - program.BuildStart).count();
+	else if (program.CompletionSeen)
+		program.CompileMs = std::chrono::duration<double, std::milli>(program.BuildEnd - program.BuildStart).count();
+	else
+		program.CompileMs = 0.0;
+	if (s_ProgramCache) //링크 실패한 프로그램은 저장하지 않음
+		s_ProgramCache->Store(program.CacheKey, program.RendererID, program.CompileMs);
+
+	program.Linked = true;
+	ReflectUniforms(program);
+	return true;
 }
 
 void Shader::Bind() const
 {
-	glUseProgram(m_RendererID);
+	GLState::UseProgram(m_Program->RendererID);
 }
 
 void Shader::Unbind() const
 {
-	glUseProgram(0);
+	GLState::UseProgram(0);
+}
+
+void Shader::SetUniform4f(int index, float v0, float v1, float v2, float v3)
+{
+	const float value[4] = { v0, v1, v2, v3 };
+	if (!UpdateShadow(index, value, sizeof(value)))
+		return;
+	glUniform4f(m_Program->Uniforms[index].Location, v0, v1, v2, v3);
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform1f(int index, float value)
 {
-	glUniform4f(GetUniformLocation(name),v0, v1, v2, v3);
+	if (!UpdateShadow(index, &value, sizeof(value)))
+		return;
+	glUniform1f(m_Program->Uniforms[index].Location, value);
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+bool Shader::UpdateShadow(int index, const void* data, uint32_t size)
 {
-	glUniform1f(GetUniformLocation(name), value);
+	if (index < 0 || index >= (int)m_Program->Uniforms.size()) //reload 이전에 얻은 index일 수 있으므로 범위도 확인
+		return false;
+
+	//uniform 값은 프로그램 객체에 남아있으므로, 지난번에 올린 값과 byte 단위로 같으면 GL 호출을 생략
+	UniformInfo& uniform = m_Program->Uniforms[index];
+	if (size > uniform.ShadowSize)
+		size = uniform.ShadowSize;
+	unsigned char* shadow = m_Program->UniformShadow.data() + uniform.ShadowOffset;
+	if (uniform.ShadowValid && std::memcmp(shadow, data, size) == 0)
+	{
+		s_UniformStats.Elided++;
+		return false;
+	}
+
+	std::memcpy(shadow, data, size);
+	uniform.ShadowValid = true;
+	s_UniformStats.Issued++;
+	return true;
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+uint32_t Shader::GetUniformTypeSize(unsigned int type)
 {
-	//반복해서 uniform을 찾지 않고 map에 저장해둠
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
+	switch (type)
+	{
+		case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL: return 4;
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 8;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+		case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: return 16;
+		case GL_FLOAT_MAT2: return 16;
+		case GL_FLOAT_MAT3: return 36;
+		case GL_FLOAT_MAT4: return 64;
+	}
+	return 4; //sampler, image 등은 int 하나로 설정됨
+}
 
-	int location = glGetUniformLocation(m_RendererID, name.c_str());
-	if (location == -1)
+int Shader::GetUniformIndex(UniformID id)
+{
+	if (m_Program->Pending) //Async 빌드 중이면 링크가 끝나야 uniform 목록을 알 수 있음
+		Wait();
+
+	//문자열 map 대신 해시로 정렬된 배열에서 찾음(할당 없음)
+	const std::vector<UniformInfo>& uniforms = m_Program->Uniforms;
+	auto it = std::lower_bound(uniforms.begin(), uniforms.end(), id.Hash,
+		[](const UniformInfo& uniform, uint32_t hash) { return uniform.Hash < hash; });
+	if (it != uniforms.end() && it->Hash == id.Hash)
+		return (int)(it - uniforms.begin());
+
+	std::vector<uint32_t>& missing = m_Program->MissingUniforms;
+	if (std::find(missing.begin(), missing.end(), id.Hash) == missing.end())
 	{
-		std::cout << "Warning: unform '" << name << "' doesn't exist!\n";
+		std::cout << "Warning: uniform(hash " << id.Hash << ") doesn't exist in " << m_FilePath << "!\n";
+		missing.push_back(id.Hash);
 	}
+	return -1;
+}
 
-	m_UniformLocationCache[name] = location;
+bool Shader::SetUniformBlockBinding(const std::string& blockName, unsigned int bindingPoint)
+{
+	if (m_Program->Pending)
+		Wait();
+
+	unsigned int blockIndex = glGetUniformBlockIndex(m_Program->RendererID, blockName.c_str());
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		std::cout << "Warning: uniform block '" << blockName << "' doesn't exist in " << m_FilePath << "!\n";
+		return false;
+	}
+
+	glUniformBlockBinding(m_Program->RendererID, blockIndex, bindingPoint);
+	return true;
+}
+
+int Shader::GetUniformLocation(UniformID id)
+{
+	int index = GetUniformIndex(id);
+	return index < 0 ? -1 : m_Program->Uniforms[index].Location;
+}
+
+void Shader::ReflectUniforms(ShaderProgram& program)
+{
+	//반복해서 uniform을 찾지 않도록 링크 직후 active uniform 전체를 한번에 얻어둠
+	std::vector<UniformInfo>& uniforms = program.Uniforms;
+	uniforms.clear();
+	program.MissingUniforms.clear();
+
+	int count = 0, maxLength = 0;
+	glGetProgramiv(program.RendererID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program.RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length = 0, size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program.RendererID, i, (int)name.size(), &length, &size, &type, name.data());
 
-	return location;
-}
\ No newline at end of file
+		int location = glGetUniformLocation(program.RendererID, name.data());
+		if (location == -1) //uniform block 안의 멤버는 location이 없음
+			continue;
+
+		std::string_view view(name.data(), length);
+		if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") //배열은 "u_Array[0]"으로 나오므로 "u_Array"로 찾을 수 있게 함
+			view.remove_suffix(3);
+
+		uint32_t shadowSize = GetUniformTypeSize(type) * size;
+		uniforms.push_back({ UniformID::HashName(view), location, type, size, std::string(view), 0, shadowSize, false });
+	}
+
+	std::sort(uniforms.begin(), uniforms.end(),
+		[](const UniformInfo& a, const UniformInfo& b) { return a.Hash < b.Hash; });
+	for (size_t i = 1; i < uniforms.size(); i++)
+	{
+		if (uniforms[i].Hash == uniforms[i - 1].Hash)
+			std::cout << "Warning: uniform '" << uniforms[i - 1].Name << "' and '" << uniforms[i].Name << "' have the same hash!\n";
+	}
+
+	//정렬된 순서(= handle 순서)대로 shadow 영역을 배치
+	uint32_t shadowSize = 0;
+	for (UniformInfo& uniform : uniforms)
+	{
+		uniform.ShadowOffset = shadowSize;
+		shadowSize += uniform.ShadowSize;
+	}
+	program.UniformShadow.assign(shadowSize, 0);
+}
+
+void Shader::CopyUniformValues(const ShaderProgram& from, ShaderProgram& to)
+{
+	unsigned int previous = GLState::GetProgram(); //glGetIntegerv로 GL에 묻지 않고 GLState가 기억하는 값 사용
+	GLState::UseProgram(to.RendererID);
+
+	for (UniformInfo& uniform : to.Uniforms)
+	{
+		auto it = std::lower_bound(from.Uniforms.begin(), from.Uniforms.end(), uniform.Hash,
+			[](const UniformInfo& u, uint32_t hash) { return u.Hash < hash; });
+		if (it == from.Uniforms.end() || it->Hash != uniform.Hash || !it->ShadowValid || it->Type != uniform.Type)
+			continue;
+
+		uint32_t size = std::min(uniform.ShadowSize, it->ShadowSize);
+		std::memcpy(to.UniformShadow.data() + uniform.ShadowOffset, from.UniformShadow.data() + it->ShadowOffset, size);
+		uniform.ShadowValid = true;
+		UploadUniform(uniform, to.UniformShadow.data() + uniform.ShadowOffset);
+	}
+
+	if (previous != GLState::Unknown) //이전 program을 모르면(외부에서 바꾼 뒤 Invalidate 등) 그대로 둠
+		GLState::UseProgram(previous);
+}
+
+void Shader::UploadUniform(const UniformInfo& uniform, const void* data)
+{
+	const float* f = (const float*)data;
+	const int* i = (const int*)data;
+	const unsigned int* u = (const unsigned int*)data;
+	switch (uniform.Type)
+	{
+		case GL_FLOAT: glUniform1fv(uniform.Location, uniform.Count, f); break;
+		case GL_FLOAT_VEC2: glUniform2fv(uniform.Location, uniform.Count, f); break;
+		case GL_FLOAT_VEC3: glUniform3fv(uniform.Location, uniform.Count, f); break;
+		case GL_FLOAT_VEC4: glUniform4fv(uniform.Location, uniform.Count, f); break;
+		case GL_INT_VEC2: case GL_BOOL_VEC2: glUniform2iv(uniform.Location, uniform.Count, i); break;
+		case GL_INT_VEC3: case GL_BOOL_VEC3: glUniform3iv(uniform.Location, uniform.Count, i); break;
+		case GL_INT_VEC4: case GL_BOOL_VEC4: glUniform4iv(uniform.Location, uniform.Count, i); break;
+		case GL_UNSIGNED_INT: glUniform1uiv(uniform.Location, uniform.Count, u); break;
+		case GL_UNSIGNED_INT_VEC2: glUniform2uiv(uniform.Location, uniform.Count, u); break;
+		case GL_UNSIGNED_INT_VEC3: glUniform3uiv(uniform.Location, uniform.Count, u); break;
+		case GL_UNSIGNED_INT_VEC4: glUniform4uiv(uniform.Location, uniform.Count, u); break;
+		case GL_FLOAT_MAT2: glUniformMatrix2fv(uniform.Location, uniform.Count, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3: glUniformMatrix3fv(uniform.Location, uniform.Count, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4: glUniformMatrix4fv(uniform.Location, uniform.Count, GL_FALSE, f); break;
+		default: glUniform1iv(uniform.Location, uniform.Count, i); break; //int, bool, sampler
+	}
+}
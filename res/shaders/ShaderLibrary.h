@@ -0,0 +1,149 @@
+
+// ShaderLibrary.h
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <filesystem>
+
+#include "Shader.h"
+
+struct ShaderLibraryStats
+{
+	unsigned int ProgramCount = 0; //현재 살아있는(서로 다른) 프로그램 수
+	unsigned int Loads = 0;
+	unsigned int Hits = 0; //이미 있는 프로그램을 돌려준 횟수
+	double CompileTimeSavedMs = 0.0; //Hits마다 다시 컴파일/링크했다면 걸렸을 시간(컴파일 시간을 잴 수 없었던 Async 빌드는 빠짐)
+};
+
+//같은 소스 + 같은 define 조합의 셰이더는 한번만 컴파일/링크하고, 여러 material이 shared_ptr로 공유하게 함.
+//키는 파일 경로(정규화) + #include까지 펼친 각 stage 소스의 해시 + 켠 feature bitmask.
+//Shader는 자기 경로로 hot reload(ShaderWatcher)와 variant 기록(ShaderVariantManifest)을 하므로, 내용이 같아도 경로가 다르면 따로 만듦.
+//이 경우 컴파일/링크는 ProgramBinaryCache(Shader::SetProgramCache)가 같은 소스의 binary를 읽어오는 것으로 한번만 일어남
+//마지막 handle이 사라지면 프로그램도 삭제됨(라이브러리는 weak_ptr만 들고 있음)
+//
+//*주의* 공유된 Shader의 SetVariant는 다른 사용자에게도 영향을 주므로, variant가 필요하면 Load에 feature를 넘겨서 얻어야 함
+class ShaderLibrary
+{
+private:
+	struct Entry
+	{
+		std::weak_ptr<Shader> Program;
+		unsigned int Hits = 0;
+		double CompileMs = 0.0; //마지막으로 확인한 컴파일 시간(Async 빌드는 완료를 본 시점이 있어야 알 수 있고, 없으면 0)
+	};
+
+	std::unordered_map<uint64_t, Entry> m_Entries;
+	ShaderLibraryStats m_Stats;
+	double m_ExpiredSavedMs; //이미 삭제된 프로그램들이 아낀 시간
+public:
+	ShaderLibrary();
+
+	std::shared_ptr<Shader> Load(const std::string& filepath, const std::vector<std::string>& features = {}, ShaderBuild build = ShaderBuild::Sync);
+
+	ShaderLibraryStats GetStats();
+private:
+	static uint64_t MakeKey(const std::string& filepath, const ShaderProgramSource& source, uint32_t mask);
+	void RemoveExpired();
+};
+
+// ShaderLibrary.cpp
+
+ShaderLibrary::ShaderLibrary()
+	: m_ExpiredSavedMs{ 0.0 }
+{
+}
+
+uint64_t ShaderLibrary::MakeKey(const std::string& filepath, const ShaderProgramSource& source, uint32_t mask)
+{
+	//"a/../b.shader"와 "b.shader"처럼 같은 파일을 다르게 적어도 같은 키가 되도록 정규화
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::weakly_canonical(filepath, error);
+	uint64_t key = ProgramBinaryCache::Hash(error ? filepath : path.string());
+
+	//선언되지 않은 feature는 mask에 들어가지 않으므로, 같은 소스에서 같은 define 조합이면 같은 키
+	key = ProgramBinaryCache::Hash({ (const char*)&mask, sizeof(mask) }, key);
+	const std::string_view* stages[] = { &source.VertexSource, &source.FragSource, &source.GeometrySource, &source.ComputeSource };
+	for (const std::string_view* stage : stages)
+	{
+		uint64_t length = stage->size(); //섹션 경계가 달라지면 키도 달라지도록 길이도 넣음
+		key = ProgramBinaryCache::Hash({ (const char*)&length, sizeof(length) }, key);
+		key = ProgramBinaryCache::Hash(*stage, key);
+	}
+	for (std::string_view feature : source.Features) //feature 순서가 바뀌면 같은 mask도 다른 define이 됨
+		key = ProgramBinaryCache::Hash(feature, ProgramBinaryCache::Hash("\n", key));
+	return key;
+}
+
+void ShaderLibrary::RemoveExpired()
+{
+	for (auto it = m_Entries.begin(); it != m_Entries.end();)
+	{
+		if (it->second.Program.expired())
+		{
+			m_ExpiredSavedMs += it->second.Hits * it->second.CompileMs;
+			it = m_Entries.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& filepath, const std::vector<std::string>& features, ShaderBuild build)
+{
+	m_Stats.Loads++;
+
+	//파싱은 ShaderSourceCache가 캐시하므로 같은 파일을 여러번 Load해도 디스크는 다시 읽지 않음
+	ShaderProgramSource source = Shader::ParseShader(filepath);
+
+	uint32_t mask = 0;
+	for (const std::string& feature : features)
+	{
+		auto it = std::find(source.Features.begin(), source.Features.end(), feature);
+		if (it == source.Features.end() || it - source.Features.begin() >= 32)
+			std::cout << "Warning: shader feature '" << feature << "' doesn't exist in " << filepath << "!\n";
+		else
+			mask |= 1u << (it - source.Features.begin());
+	}
+
+	uint64_t key = MakeKey(filepath, source, mask);
+	auto it = m_Entries.find(key);
+	if (it != m_Entries.end())
+	{
+		if (std::shared_ptr<Shader> shader = it->second.Program.lock())
+		{
+			it->second.Hits++;
+			m_Stats.Hits++;
+			if (build == ShaderBuild::Sync)
+				shader->Wait(); //Async로 먼저 Load된 경우에도 Sync 요청이면 링크까지 기다림
+			it->second.CompileMs = shader->GetCompileTime();
+			return shader;
+		}
+	}
+
+	RemoveExpired();
+
+	auto shader = std::make_shared<Shader>(filepath, source, mask, build);
+	m_Entries[key].Program = shader;
+	return shader;
+}
+
+ShaderLibraryStats ShaderLibrary::GetStats()
+{
+	RemoveExpired();
+
+	ShaderLibraryStats stats = m_Stats;
+	stats.ProgramCount = (unsigned int)m_Entries.size();
+	stats.CompileTimeSavedMs = m_ExpiredSavedMs;
+	for (auto& entry : m_Entries)
+	{
+		if (std::shared_ptr<Shader> shader = entry.second.Program.lock())
+			entry.second.CompileMs = shader->GetCompileTime();
+		stats.CompileTimeSavedMs += entry.second.Hits * entry.second.CompileMs;
+	}
+	return stats;
+}
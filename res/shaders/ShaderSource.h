@@ -0,0 +1,378 @@
+
+// ShaderSource.h
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+//각 stage 소스는 파일 전체를 읽어둔 Text 버퍼(또는 #include를 펼친 Expanded 버퍼)를 가리키는 view(복사 없음). 버퍼가 살아있는 동안만 유효
+struct ShaderProgramSource
+{
+	std::shared_ptr<const std::string> Text;
+	std::string_view VertexSource;
+	std::string_view FragSource;
+	std::string_view GeometrySource;
+	std::string_view ComputeSource;
+	std::vector<std::string_view> Features; //첫 "#shader" 이전의 "#feature 이름" 선언들, 순서가 곧 variant bitmask의 bit 순서
+
+	//.shader 파일에서 각 섹션이 시작하는 줄 번호. 컴파일할 때 #line으로 넣어서 에러 메시지의 줄 번호가 파일과 맞게 함
+	int VertexLine = 1;
+	int FragLine = 1;
+	int GeometryLine = 1;
+	int ComputeLine = 1;
+
+	std::vector<std::string> Files; //#line의 source 번호 -> 파일 경로. 0번은 .shader 파일 자신, 나머지는 include 파일
+	std::vector<std::shared_ptr<const std::string>> Expanded; //#include를 펼친 섹션들의 버퍼
+};
+
+struct ShaderSourceCacheStats
+{
+	unsigned int FileReads = 0; //디스크에서 실제로 읽은 횟수
+	unsigned int FileHits = 0; //수정 시간이 같아서 읽지 않은 횟수
+	unsigned int ParseHits = 0; //파일과 include가 모두 그대로라 파싱 결과를 재사용한 횟수
+	unsigned int ParseMisses = 0;
+};
+
+//.shader 파일과 include 파일의 내용, 그리고 #include를 펼친 파싱 결과를 메모리에 들고 있음.
+//파일은 경로 + 수정 시간으로 확인하고(바뀌었으면 다시 읽음), 파싱 결과는 자신과 모든 include의 내용이 같을 때만 재사용.
+//다시 읽은 내용이 이전과 같으면 이전 버퍼를 계속 쓰므로, 내용 비교는 버퍼 포인터 비교로 끝남(해시 계산 없음)
+class ShaderSourceCache
+{
+private:
+	struct File
+	{
+		std::shared_ptr<const std::string> Text;
+		std::filesystem::file_time_type WriteTime;
+	};
+
+	//파일 경로, 파싱할 때의 버퍼(없는 파일이면 nullptr). 버퍼를 같이 들고 있어야 해제된 주소가 새 버퍼에 재사용되어 포인터 비교가 잘못 맞는 일이 없음
+	using Dependency = std::pair<std::string, std::shared_ptr<const std::string>>;
+
+	struct Parsed
+	{
+		ShaderProgramSource Source;
+		std::vector<Dependency> Dependencies;
+	};
+
+	std::unordered_map<std::string, File> m_Files;
+	std::unordered_map<std::string, Parsed> m_Parsed;
+	ShaderSourceCacheStats m_Stats;
+	std::mutex m_Mutex; //hot reload 스레드에서도 호출됨
+public:
+	ShaderProgramSource Parse(const std::string& filepath);
+	void Clear();
+	ShaderSourceCacheStats GetStats();
+private:
+	bool GetFile(const std::string& path, File& result);
+	static int CountLines(const char* begin, const char* end); //'\n' 개수
+	ShaderProgramSource ParseFile(const std::string& path, const File& file, std::vector<Dependency>& dependencies);
+	void ExpandIncludes(std::string_view text, const std::string& path, int fileIndex, int firstLine, std::string& out,
+		ShaderProgramSource& source, std::vector<std::string>& included, std::vector<Dependency>& dependencies);
+};
+
+// ShaderSource.cpp
+
+ShaderProgramSource ShaderSourceCache::Parse(const std::string& filepath)
+{
+	std::string path = std::filesystem::path(filepath).lexically_normal().string();
+
+	//이전 파싱 결과가 있으면, 의존하는 파일들의 내용이 그대로인지만 확인(수정 시간이 같으면 디스크를 읽지 않음)
+	std::vector<Dependency> dependencies;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Parsed.find(path);
+		if (it != m_Parsed.end())
+			dependencies = it->second.Dependencies;
+	}
+	if (!dependencies.empty())
+	{
+		bool valid = true;
+		for (const auto& dependency : dependencies)
+		{
+			File file;
+			if (!GetFile(dependency.first, file) || file.Text != dependency.second)
+			{
+				valid = false;
+				break;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Parsed.find(path);
+		if (valid && it != m_Parsed.end())
+		{
+			m_Stats.ParseHits++;
+			return it->second.Source;
+		}
+	}
+
+	File file;
+	if (!GetFile(path, file))
+	{
+		std::cout << "Warning: shader file '" << filepath << "' doesn't exist!\n";
+		return {};
+	}
+
+	dependencies.clear();
+	ShaderProgramSource source = ParseFile(path, file, dependencies);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.ParseMisses++;
+	m_Parsed[path] = { source, std::move(dependencies) };
+	return source;
+}
+
+void ShaderSourceCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Files.clear();
+	m_Parsed.clear();
+}
+
+ShaderSourceCacheStats ShaderSourceCache::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+bool ShaderSourceCache::GetFile(const std::string& path, File& result)
+{
+	std::error_code error;
+	auto writeTime = std::filesystem::last_write_time(path, error);
+	if (error)
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Files.find(path);
+		if (it != m_Files.end() && it->second.WriteTime == writeTime) //stat은 한 번만(크기는 읽을 때 열린 파일에서 얻음)
+		{
+			m_Stats.FileHits++;
+			result = it->second;
+			return true;
+		}
+	}
+
+	//파일 전체를 한번에 읽음(줄 단위로 읽으면서 stringstream에 넣으면 줄마다 할당이 생김)
+	std::FILE* stream = std::fopen(path.c_str(), "rb");
+	if (!stream)
+		return false;
+	std::fseek(stream, 0, SEEK_END);
+	long size = std::ftell(stream);
+	std::fseek(stream, 0, SEEK_SET);
+	auto text = std::make_shared<std::string>(size > 0 ? (size_t)size : 0, '\0');
+	text->resize(std::fread(text->data(), 1, text->size(), stream));
+	std::fclose(stream);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.FileReads++;
+	File& file = m_Files[path];
+	if (!file.Text || *file.Text != *text) //저장만 하고 내용이 같으면 기존 버퍼(와 그걸 가리키는 파싱 결과)를 그대로 사용
+		file.Text = text;
+	file.WriteTime = writeTime;
+	result = file;
+	return true;
+}
+
+int ShaderSourceCache::CountLines(const char* begin, const char* end)
+{
+	//8 byte씩 읽어서 '\n'인 byte를 한번에 셈(std::count는 byte 단위라 큰 파일에서 파싱 시간 대부분을 차지함)
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t low7 = 0x7F7F7F7F7F7F7F7Full;
+	int lines = 0;
+	for (; end - begin >= 8; begin += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, begin, 8);
+		word ^= ones * '\n';
+		uint64_t zero = ~(((word & low7) + low7) | word | low7) >> 7; //0인 byte만 1
+		lines += (int)((zero * ones) >> 56); //byte들의 합이 최상위 byte에 모임
+	}
+	for (; begin < end; begin++)
+		lines += *begin == '\n';
+	return lines;
+}
+
+ShaderProgramSource ShaderSourceCache::ParseFile(const std::string& path, const File& file, std::vector<Dependency>& dependencies)
+{
+	ShaderProgramSource source;
+	source.Text = file.Text;
+	source.Files.push_back(path);
+	dependencies.push_back({ path, file.Text });
+
+	//"#shader" 마커 사이의 구간을 view로 잘라냄. 첫 마커 이전의 텍스트("#feature" 제외)나 모르는 stage는 무시
+	const char* begin = file.Text->data();
+	const char* end = begin + file.Text->size();
+	const char* cursor = begin;
+	const char* sectionStart = nullptr;
+	std::string_view* section = nullptr;
+	int* sectionLine = nullptr;
+	const char* counted = begin; //줄 번호는 여기까지 센 상태
+	int line = 1;
+	while (cursor < end && (cursor = (const char*)std::memchr(cursor, '#', end - cursor)) != nullptr)
+	{
+		//첫 "#shader" 이전의 "#feature 이름" 줄은 variant에서 켤 수 있는 define 목록
+		if (!sectionStart && end - cursor > 8 && std::memcmp(cursor, "#feature", 8) == 0)
+		{
+			const char* lineEnd = (const char*)std::memchr(cursor, '\n', end - cursor);
+			std::string_view featureLine(cursor + 8, (lineEnd ? lineEnd : end) - cursor - 8);
+			size_t first = featureLine.find_first_not_of(" \t\r");
+			if (first != std::string_view::npos)
+			{
+				featureLine.remove_prefix(first);
+				source.Features.push_back(featureLine.substr(0, featureLine.find_first_of(" \t\r")));
+			}
+			cursor = lineEnd ? lineEnd + 1 : end;
+			continue;
+		}
+
+		if (end - cursor < 7 || std::memcmp(cursor, "#shader", 7) != 0)
+		{
+			cursor++;
+			continue;
+		}
+
+		const char* lineStart = cursor;
+		while (lineStart > begin && lineStart[-1] != '\n')
+			lineStart--;
+		const char* lineEnd = (const char*)std::memchr(cursor, '\n', end - cursor);
+		if (!lineEnd)
+			lineEnd = end;
+
+		if (section) //이전 섹션은 마커가 있는 줄 직전에서 끝남
+			*section = std::string_view(sectionStart, lineStart - sectionStart);
+
+		std::string_view directive(cursor + 7, lineEnd - cursor - 7);
+		if (directive.find("vertex") != std::string_view::npos) //vertex 셰이더 섹션
+		{
+			section = &source.VertexSource;
+			sectionLine = &source.VertexLine;
+		}
+		else if (directive.find("fragment") != std::string_view::npos) //fragment 셰이더 섹션
+		{
+			section = &source.FragSource;
+			sectionLine = &source.FragLine;
+		}
+		else if (directive.find("geometry") != std::string_view::npos)
+		{
+			section = &source.GeometrySource;
+			sectionLine = &source.GeometryLine;
+		}
+		else if (directive.find("compute") != std::string_view::npos)
+		{
+			section = &source.ComputeSource;
+			sectionLine = &source.ComputeLine;
+		}
+		else
+		{
+			std::cout << "Warning: unknown shader section '" << directive << "' in " << path << "\n";
+			section = nullptr;
+		}
+
+		sectionStart = lineEnd < end ? lineEnd + 1 : end;
+		line += CountLines(counted, sectionStart);
+		counted = sectionStart;
+		if (section)
+			*sectionLine = line;
+		cursor = sectionStart;
+	}
+	if (section)
+		*section = std::string_view(sectionStart, end - sectionStart);
+
+	//#include가 있는 섹션만 펼친 버퍼를 새로 만들고, 없으면 파일 버퍼를 그대로 가리킴
+	std::pair<std::string_view*, int> stages[] = {
+		{ &source.VertexSource, source.VertexLine }, { &source.FragSource, source.FragLine },
+		{ &source.GeometrySource, source.GeometryLine }, { &source.ComputeSource, source.ComputeLine } };
+	for (auto& stage : stages)
+	{
+		if (stage.first->find("#include") == std::string_view::npos)
+			continue;
+
+		auto expanded = std::make_shared<std::string>();
+		std::vector<std::string> included; //include guard: 한 섹션 안에서 같은 파일은 한번만 펼침
+		ExpandIncludes(*stage.first, path, 0, stage.second, *expanded, source, included, dependencies);
+		source.Expanded.push_back(expanded);
+		*stage.first = *expanded;
+	}
+
+	return source;
+}
+
+void ShaderSourceCache::ExpandIncludes(std::string_view text, const std::string& path, int fileIndex, int firstLine, std::string& out,
+	ShaderProgramSource& source, std::vector<std::string>& included, std::vector<Dependency>& dependencies)
+{
+	int line = firstLine;
+	size_t position = 0;
+	while (position < text.size())
+	{
+		size_t lineEnd = text.find('\n', position);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+		std::string_view current = text.substr(position, lineEnd - position);
+		position = lineEnd + 1;
+
+		size_t first = current.find_first_not_of(" \t");
+		if (first == std::string_view::npos || current.compare(first, 8, "#include") != 0)
+		{
+			out += current;
+			out += '\n';
+			line++;
+			continue;
+		}
+
+		size_t open = current.find('"', first + 8);
+		size_t close = open == std::string_view::npos ? open : current.find('"', open + 1);
+		if (close == std::string_view::npos)
+		{
+			out += "#error malformed #include\n";
+			line++;
+			continue;
+		}
+
+		//include 경로는 include하는 파일의 위치 기준
+		std::string name(current.substr(open + 1, close - open - 1));
+		std::string includePath = (std::filesystem::path(path).parent_path() / name).lexically_normal().string();
+		if (std::find(included.begin(), included.end(), includePath) != included.end())
+		{
+			out += '\n'; //이미 펼친 파일은 빈 줄로 두어 줄 번호를 유지
+			line++;
+			continue;
+		}
+		included.push_back(includePath);
+
+		File file;
+		if (!GetFile(includePath, file))
+		{
+			std::cout << "Warning: include file '" << includePath << "' doesn't exist! (" << path << ":" << line << ")\n";
+			out += "#error include file not found: " + name + "\n";
+			dependencies.push_back({ includePath, nullptr }); //파일이 생기면 다시 파싱하도록 의존성에는 남겨둠
+			if (std::find(source.Files.begin(), source.Files.end(), includePath) == source.Files.end())
+				source.Files.push_back(includePath); //hot reload 감시 대상
+			line++;
+			continue;
+		}
+		dependencies.push_back({ includePath, file.Text });
+
+		auto it = std::find(source.Files.begin(), source.Files.end(), includePath);
+		int index = (int)(it - source.Files.begin());
+		if (it == source.Files.end())
+			source.Files.push_back(includePath);
+
+		//include 파일의 줄은 "#line 줄 파일번호"로 표시해서 에러 메시지가 원래 파일을 가리키게 함
+		out += "#line 1 " + std::to_string(index) + "\n";
+		ExpandIncludes(*file.Text, includePath, index, 1, out, source, included, dependencies);
+		line++;
+		out += "#line " + std::to_string(line) + " " + std::to_string(fileIndex) + "\n";
+	}
+}
@@ -0,0 +1,96 @@
+
+// ShaderVariantManifest.h
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+
+//실행 중에 실제로 사용된 셰이더 variant(파일 경로 + feature 이름 목록)를 기록해두는 파일.
+//다음 실행때 Shader 생성자가 이 목록의 variant를 미리 빌드 제출해서, 처음 사용할 때 컴파일로 멈추는 일이 없게 함
+//파일 형식: 한 줄에 "셰이더경로 FEATURE_A FEATURE_B ..." (feature가 없으면 경로만)
+class ShaderVariantManifest
+{
+private:
+	std::string m_FilePath;
+	std::map<std::string, std::set<std::vector<std::string>>> m_Variants; //셰이더 경로 -> feature 이름 목록들
+	bool m_Dirty;
+	mutable std::mutex m_Mutex;
+public:
+	ShaderVariantManifest(const std::string& filepath); //파일이 있으면 읽어옴
+
+	void Record(const std::string& shaderPath, const std::vector<std::string>& features);
+	std::vector<std::vector<std::string>> GetVariants(const std::string& shaderPath) const;
+	bool Save(); //바뀐 내용이 있을 때만 저장
+};
+
+// ShaderVariantManifest.cpp
+
+ShaderVariantManifest::ShaderVariantManifest(const std::string& filepath)
+	: m_FilePath{ filepath }, m_Dirty{ false }
+{
+	std::ifstream stream(filepath);
+	std::string line;
+	while (getline(stream, line))
+	{
+		std::istringstream words(line);
+		std::string path;
+		if (!(words >> path))
+			continue;
+
+		std::vector<std::string> features;
+		std::string feature;
+		while (words >> feature)
+			features.push_back(feature);
+		m_Variants[path].insert(features);
+	}
+}
+
+void ShaderVariantManifest::Record(const std::string& shaderPath, const std::vector<std::string>& features)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Variants[shaderPath].insert(features).second)
+		m_Dirty = true;
+}
+
+std::vector<std::vector<std::string>> ShaderVariantManifest::GetVariants(const std::string& shaderPath) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Variants.find(shaderPath);
+	if (it == m_Variants.end())
+		return {};
+	return { it->second.begin(), it->second.end() };
+}
+
+bool ShaderVariantManifest::Save()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_Dirty)
+		return true;
+
+	std::ofstream stream(m_FilePath, std::ios::trunc);
+	for (const auto& shader : m_Variants)
+	{
+		for (const auto& features : shader.second)
+		{
+			stream << shader.first;
+			for (const std::string& feature : features)
+				stream << ' ' << feature;
+			stream << '\n';
+		}
+	}
+	if (!stream)
+	{
+		std::cout << "Warning: shader variant manifest '" << m_FilePath << "' 저장 실패\n";
+		return false;
+	}
+
+	m_Dirty = false;
+	return true;
+}
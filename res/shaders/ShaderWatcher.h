@@ -0,0 +1,260 @@
+
+// ShaderWatcher.h
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "Shader.h"
+
+//.shader 파일(과 include하는 파일)이 바뀌면 백그라운드 스레드에서 다시 파싱하고,
+//Update()가 불리는 frame 경계에서 비동기 빌드를 제출/교체함. 컴파일에 실패하면 기존 프로그램을 그대로 사용
+//Linux는 inotify로 디렉터리를 감시하고, 그 외 플랫폼은 수정 시간을 주기적으로 확인
+class ShaderWatcher
+{
+private:
+	struct Entry
+	{
+		Shader* shader;
+		std::vector<std::string> files; //절대 경로
+	};
+
+	std::vector<Entry> m_Entries;
+	std::vector<std::pair<Shader*, ShaderProgramSource>> m_Parsed; //백그라운드에서 파싱을 마친 소스
+	std::vector<Shader*> m_Reloading; //빌드 제출 후 완료를 기다리는 셰이더
+	std::mutex m_Mutex;
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+
+#ifdef __linux__
+	int m_Inotify;
+	std::unordered_map<int, std::string> m_WatchedDirectories; //watch descriptor -> 디렉터리
+#else
+	std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+#endif
+public:
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	void Watch(Shader& shader); //shader가 파괴되기 전에 Unwatch 해야 함
+	void Unwatch(Shader& shader);
+
+	void Update(); //GL context가 있는 스레드에서 frame 경계마다 호출
+private:
+	void Run();
+	void OnFileChanged(const std::string& path);
+	void AddFiles(Entry& entry, const std::vector<std::string>& files);
+	static std::string Normalize(const std::string& path);
+};
+
+// ShaderWatcher.cpp
+
+ShaderWatcher::ShaderWatcher()
+	: m_Running{ true }
+{
+#ifdef __linux__
+	m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Inotify < 0)
+		std::cout << "Warning: inotify_init 실패, shader hot reload 비활성화\n";
+#endif
+	m_Thread = std::thread(&ShaderWatcher::Run, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	m_Running = false;
+	if (m_Thread.joinable())
+		m_Thread.join();
+#ifdef __linux__
+	if (m_Inotify >= 0)
+		close(m_Inotify);
+#endif
+}
+
+std::string ShaderWatcher::Normalize(const std::string& path)
+{
+	std::error_code error;
+	std::filesystem::path result = std::filesystem::weakly_canonical(path, error);
+	return error ? path : result.string();
+}
+
+void ShaderWatcher::AddFiles(Entry& entry, const std::vector<std::string>& files)
+{
+	entry.files.clear();
+	for (const std::string& file : files)
+	{
+		std::string path = Normalize(file);
+		entry.files.push_back(path);
+
+#ifdef __linux__
+		//에디터는 파일을 새로 만들어 rename하는 경우가 많으므로 파일이 아닌 디렉터리를 감시
+		if (m_Inotify < 0)
+			continue;
+		std::string directory = std::filesystem::path(path).parent_path().string();
+		int wd = inotify_add_watch(m_Inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (wd >= 0)
+			m_WatchedDirectories[wd] = directory;
+#else
+		std::error_code error;
+		m_WriteTimes[path] = std::filesystem::last_write_time(path, error);
+#endif
+	}
+}
+
+void ShaderWatcher::Watch(Shader& shader)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries.push_back({ &shader, {} });
+	AddFiles(m_Entries.back(), shader.GetDependencies());
+}
+
+void ShaderWatcher::Unwatch(Shader& shader)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+		[&](const Entry& entry) { return entry.shader == &shader; }), m_Entries.end());
+	m_Parsed.erase(std::remove_if(m_Parsed.begin(), m_Parsed.end(),
+		[&](const auto& parsed) { return parsed.first == &shader; }), m_Parsed.end());
+	m_Reloading.erase(std::remove(m_Reloading.begin(), m_Reloading.end(), &shader), m_Reloading.end());
+}
+
+void ShaderWatcher::OnFileChanged(const std::string& path)
+{
+	//바뀐 파일에 의존하는 셰이더를 찾아서 백그라운드 스레드(현재 스레드)에서 다시 파싱
+	std::vector<std::pair<Shader*, std::string>> dirty;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (const Entry& entry : m_Entries)
+		{
+			if (std::find(entry.files.begin(), entry.files.end(), path) != entry.files.end())
+				dirty.push_back({ entry.shader, entry.shader->GetFilePath() });
+		}
+	}
+
+	for (const auto& item : dirty)
+	{
+		ShaderProgramSource source = Shader::ParseShader(item.second);
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		bool watched = std::any_of(m_Entries.begin(), m_Entries.end(), [&](const Entry& entry) { return entry.shader == item.first; });
+		if (watched) //파싱하는 동안 Unwatch 되었을 수 있음
+			m_Parsed.push_back({ item.first, std::move(source) });
+	}
+}
+
+void ShaderWatcher::Run()
+{
+#ifdef __linux__
+	if (m_Inotify < 0)
+		return;
+
+	alignas(inotify_event) char buffer[4096];
+	while (m_Running)
+	{
+		pollfd descriptor{ m_Inotify, POLLIN, 0 };
+		if (poll(&descriptor, 1, 100) <= 0) //종료 여부를 확인할 수 있도록 100ms마다 깨어남
+			continue;
+
+		std::vector<std::string> changed;
+		ssize_t length;
+		while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len)
+			{
+				const inotify_event* event = (const inotify_event*)ptr;
+				if (event->len == 0)
+					continue;
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				auto it = m_WatchedDirectories.find(event->wd);
+				if (it != m_WatchedDirectories.end())
+					changed.push_back(it->second + "/" + event->name);
+			}
+		}
+
+		//한번 저장할 때 이벤트가 여러개 오므로 중복 제거
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+		for (const std::string& path : changed)
+			OnFileChanged(path);
+	}
+#else
+	while (m_Running)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+		std::vector<std::string> changed;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (auto& file : m_WriteTimes)
+			{
+				std::error_code error;
+				auto time = std::filesystem::last_write_time(file.first, error);
+				if (!error && time != file.second)
+				{
+					file.second = time;
+					changed.push_back(file.first);
+				}
+			}
+		}
+		for (const std::string& path : changed)
+			OnFileChanged(path);
+	}
+#endif
+}
+
+void ShaderWatcher::Update()
+{
+	std::vector<std::pair<Shader*, ShaderProgramSource>> parsed;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		parsed.swap(m_Parsed);
+	}
+
+	//빌드 제출만 하고 바로 반환(KHR_parallel_shader_compile이 있으면 드라이버 스레드에서 컴파일)
+	for (auto& item : parsed)
+	{
+		item.first->Reload(item.second);
+		if (std::find(m_Reloading.begin(), m_Reloading.end(), item.first) == m_Reloading.end())
+			m_Reloading.push_back(item.first);
+	}
+
+	for (size_t i = 0; i < m_Reloading.size();)
+	{
+		Shader* shader = m_Reloading[i];
+		ShaderReload result = shader->UpdateReload();
+		if (result == ShaderReload::Pending)
+		{
+			i++;
+			continue;
+		}
+
+		if (result == ShaderReload::Swapped)
+		{
+			std::cout << "셰이더 리로드: " << shader->GetFilePath() << std::endl;
+
+			//include 목록이 바뀌었을 수 있으므로 감시 대상 갱신
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (Entry& entry : m_Entries)
+			{
+				if (entry.shader == shader)
+					AddFiles(entry, shader->GetDependencies());
+			}
+		}
+		m_Reloading.erase(m_Reloading.begin() + i);
+	}
+}
@@ -0,0 +1,393 @@
+
+// GLState.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <cstdint>
+
+//frame 하나 동안의 상태 변경 수. BeginFrame()에서 초기화
+struct GLStateStats
+{
+	unsigned int Issued = 0; //실제로 GL을 호출한 수
+	unsigned int Skipped = 0; //이미 같은 상태여서 생략한 수
+};
+
+//현재 GL 상태(program, VAO, target별 버퍼, texture unit별 texture, blend/depth, viewport)를 기억해서 같은 값으로 바꾸는 호출을 생략.
+//Shader/VertexArray/VertexBuffer/IndexBuffer 등의 Bind()/Unbind()는 모두 여기를 거침. context는 하나라고 가정.
+//이 클래스를 거치지 않고 GL 상태를 바꿨다면(외부 라이브러리, imgui 등) 그 뒤에 Invalidate()를 호출해야 함.
+//
+//주의할 점
+//  - GL_ELEMENT_ARRAY_BUFFER binding은 VAO의 상태이므로 VAO가 바뀌면 모르는 값으로 둠
+//  - 객체를 삭제하면 GL이 같은 이름을 다시 쓸 수 있으므로 삭제할 때 OnDelete*()로 알려줘야 함
+class GLState
+{
+public:
+	static constexpr unsigned int Unknown = 0xFFFFFFFF; //모르는 상태(다음 호출은 항상 GL로 전달). 유효한 GL 이름과 겹치지 않음
+private:
+	static constexpr unsigned int s_BufferTargetCount = 9;
+	static constexpr unsigned int s_IndexedBindingCount = 16;
+	static constexpr unsigned int s_TextureUnitCount = 32; //QuadBatch가 batch 하나에 최대 32개 사용
+	static constexpr unsigned int s_CapabilityCount = 7;
+
+	struct IndexedBinding
+	{
+		unsigned int Buffer;
+		unsigned int Offset;
+		unsigned int Size;
+	};
+
+	inline static unsigned int s_Program = Unknown;
+	inline static unsigned int s_VertexArray = Unknown;
+	inline static unsigned int s_Buffers[s_BufferTargetCount] = {};
+	inline static IndexedBinding s_UniformBindings[s_IndexedBindingCount];
+	inline static unsigned int s_ActiveTexture = Unknown;
+	inline static unsigned int s_Textures[s_TextureUnitCount] = {};
+	inline static unsigned int s_TextureTargets[s_TextureUnitCount] = {};
+	inline static unsigned char s_Capabilities[s_CapabilityCount] = {}; //0: 모름, 1: 꺼짐, 2: 켜짐
+	inline static unsigned int s_BlendSource = Unknown, s_BlendDestination = Unknown;
+	inline static unsigned int s_DepthFunc = Unknown;
+	inline static unsigned int s_DepthMask = Unknown;
+	inline static unsigned int s_ColorMask = Unknown;
+	inline static unsigned int s_PrimitiveRestartIndex = 0;
+	inline static bool s_PrimitiveRestartIndexKnown = false; //0xFFFFFFFF는 유효한 restart index이므로 Unknown을 쓸 수 없음
+	inline static int s_Viewport[4] = { -1, -1, -1, -1 };
+	inline static unsigned int s_BufferGeneration = 0; //OnDeleteBuffer마다 증가
+	inline static bool s_Initialized = false;
+
+	inline static GLStateStats s_Stats;
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size);
+	static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	static void Enable(unsigned int capability) { SetCapability(capability, true); }
+	static void Disable(unsigned int capability) { SetCapability(capability, false); }
+	static void SetCapability(unsigned int capability, bool enabled);
+	static void BlendFunc(unsigned int source, unsigned int destination);
+	static void DepthFunc(unsigned int func);
+	static void DepthMask(bool write);
+	static void ColorMask(bool red, bool green, bool blue, bool alpha);
+	static void PrimitiveRestartIndex(unsigned int index);
+	static void Viewport(int x, int y, int width, int height);
+
+	inline static unsigned int GetProgram() { return s_Program; }
+	inline static unsigned int GetVertexArray() { return s_VertexArray; }
+	//버퍼가 삭제될 때마다 바뀜. GL 버퍼 이름을 따로 기억해두는 곳(VertexArray의 binding 등)은 이 값이 바뀌면 기억한 이름을 버려야 함
+	inline static unsigned int GetBufferGeneration() { return s_BufferGeneration; }
+
+	//객체를 삭제할 때 호출(삭제는 호출한 쪽에서). 그 객체가 bind되어 있던 곳은 GL처럼 0으로 둠
+	static void OnDeleteProgram(unsigned int program);
+	static void OnDeleteVertexArray(unsigned int vertexArray);
+	static void OnDeleteBuffer(unsigned int buffer);
+	static void OnDeleteTexture(unsigned int texture);
+	//DSA 함수 등으로 bind 없이 target의 binding이 바뀌었을 수 있을 때
+	static void InvalidateBuffer(unsigned int target);
+	static void Invalidate(); //모든 상태를 모르는 값으로
+
+	static void BeginFrame() { s_Stats = GLStateStats{}; }
+	inline static const GLStateStats& GetFrameStats() { return s_Stats; }
+	static void PrintFrameStats();
+private:
+	static void Initialize();
+	static int BufferSlot(unsigned int target);
+	static int CapabilitySlot(unsigned int capability);
+	//cached == value이면 생략하고 false, 아니면 기록하고 true
+	static bool Change(unsigned int& cached, unsigned int value);
+};
+
+// GLState.cpp
+
+void GLState::Initialize()
+{
+	if (s_Initialized)
+		return;
+	s_Initialized = true;
+	Invalidate();
+}
+
+bool GLState::Change(unsigned int& cached, unsigned int value)
+{
+	if (cached == value)
+	{
+		s_Stats.Skipped++;
+		return false;
+	}
+	cached = value;
+	s_Stats.Issued++;
+	return true;
+}
+
+int GLState::BufferSlot(unsigned int target)
+{
+	switch (target)
+	{
+		case GL_ARRAY_BUFFER: return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_UNIFORM_BUFFER: return 2;
+		case GL_COPY_READ_BUFFER: return 3;
+		case GL_COPY_WRITE_BUFFER: return 4;
+		case GL_PIXEL_PACK_BUFFER: return 5;
+		case GL_PIXEL_UNPACK_BUFFER: return 6;
+		case GL_DRAW_INDIRECT_BUFFER: return 7;
+		case GL_SHADER_STORAGE_BUFFER: return 8;
+	}
+	return -1; //기억하지 않는 target은 항상 GL로 전달
+}
+
+int GLState::CapabilitySlot(unsigned int capability)
+{
+	switch (capability)
+	{
+		case GL_BLEND: return 0;
+		case GL_DEPTH_TEST: return 1;
+		case GL_CULL_FACE: return 2;
+		case GL_SCISSOR_TEST: return 3;
+		case GL_STENCIL_TEST: return 4;
+		case GL_PRIMITIVE_RESTART: return 5;
+		case GL_MULTISAMPLE: return 6;
+	}
+	return -1;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+	Initialize();
+	if (Change(s_Program, program))
+		glUseProgram(program);
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+	Initialize();
+	if (Change(s_VertexArray, vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+		s_Buffers[BufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = Unknown; //VAO마다 다름
+	}
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	Initialize();
+	int slot = BufferSlot(target);
+	if (slot < 0)
+	{
+		s_Stats.Issued++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+	if (Change(s_Buffers[slot], buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLState::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	Initialize();
+	if (target == GL_UNIFORM_BUFFER && index < s_IndexedBindingCount)
+	{
+		IndexedBinding& binding = s_UniformBindings[index];
+		if (binding.Buffer == buffer && binding.Offset == offset && binding.Size == size)
+		{
+			s_Stats.Skipped++;
+			return;
+		}
+		binding = { buffer, offset, size };
+	}
+	s_Stats.Issued++;
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	//glBindBufferRange는 generic binding(glBindBuffer와 같은 곳)도 바꿈
+	int slot = BufferSlot(target);
+	if (slot >= 0)
+		s_Buffers[slot] = buffer;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	Initialize();
+	if (unit >= s_TextureUnitCount)
+	{
+		s_Stats.Issued += 2;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(target, texture);
+		s_ActiveTexture = unit;
+		return;
+	}
+	if (s_Textures[unit] == texture && s_TextureTargets[unit] == target)
+	{
+		s_Stats.Skipped++;
+		return;
+	}
+	if (Change(s_ActiveTexture, unit))
+		glActiveTexture(GL_TEXTURE0 + unit);
+	s_Textures[unit] = texture;
+	s_TextureTargets[unit] = target;
+	s_Stats.Issued++;
+	glBindTexture(target, texture);
+}
+
+void GLState::SetCapability(unsigned int capability, bool enabled)
+{
+	Initialize();
+	int slot = CapabilitySlot(capability);
+	unsigned char value = enabled ? 2 : 1;
+	if (slot >= 0)
+	{
+		if (s_Capabilities[slot] == value)
+		{
+			s_Stats.Skipped++;
+			return;
+		}
+		s_Capabilities[slot] = value;
+	}
+	s_Stats.Issued++;
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void GLState::BlendFunc(unsigned int source, unsigned int destination)
+{
+	Initialize();
+	if (s_BlendSource == source && s_BlendDestination == destination)
+	{
+		s_Stats.Skipped++;
+		return;
+	}
+	s_BlendSource = source;
+	s_BlendDestination = destination;
+	s_Stats.Issued++;
+	glBlendFunc(source, destination);
+}
+
+void GLState::DepthFunc(unsigned int func)
+{
+	Initialize();
+	if (Change(s_DepthFunc, func))
+		glDepthFunc(func);
+}
+
+void GLState::DepthMask(bool write)
+{
+	Initialize();
+	if (Change(s_DepthMask, write ? 1 : 0))
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::ColorMask(bool red, bool green, bool blue, bool alpha)
+{
+	Initialize();
+	unsigned int mask = (red ? 1 : 0) | (green ? 2 : 0) | (blue ? 4 : 0) | (alpha ? 8 : 0);
+	if (Change(s_ColorMask, mask))
+		glColorMask(red, green, blue, alpha);
+}
+
+void GLState::PrimitiveRestartIndex(unsigned int index)
+{
+	Initialize();
+	if (s_PrimitiveRestartIndexKnown && s_PrimitiveRestartIndex == index)
+	{
+		s_Stats.Skipped++;
+		return;
+	}
+	s_PrimitiveRestartIndexKnown = true;
+	s_PrimitiveRestartIndex = index;
+	s_Stats.Issued++;
+	glPrimitiveRestartIndex(index);
+}
+
+void GLState::Viewport(int x, int y, int width, int height)
+{
+	Initialize();
+	if (s_Viewport[0] == x && s_Viewport[1] == y && s_Viewport[2] == width && s_Viewport[3] == height)
+	{
+		s_Stats.Skipped++;
+		return;
+	}
+	s_Viewport[0] = x;
+	s_Viewport[1] = y;
+	s_Viewport[2] = width;
+	s_Viewport[3] = height;
+	s_Stats.Issued++;
+	glViewport(x, y, width, height);
+}
+
+void GLState::OnDeleteProgram(unsigned int program)
+{
+	//사용 중인 program은 삭제해도 계속 사용되므로 0이 아니라 모르는 값으로 둠
+	if (s_Program == program)
+		s_Program = Unknown;
+}
+
+void GLState::OnDeleteVertexArray(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+	{
+		s_VertexArray = 0;
+		s_Buffers[BufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = 0;
+	}
+}
+
+void GLState::OnDeleteBuffer(unsigned int buffer)
+{
+	s_BufferGeneration++;
+	for (unsigned int& bound : s_Buffers)
+	{
+		if (bound == buffer)
+			bound = 0;
+	}
+	for (IndexedBinding& binding : s_UniformBindings)
+	{
+		if (binding.Buffer == buffer)
+			binding = { Unknown, 0, 0 };
+	}
+}
+
+void GLState::OnDeleteTexture(unsigned int texture)
+{
+	for (unsigned int& bound : s_Textures)
+	{
+		if (bound == texture)
+			bound = Unknown;
+	}
+}
+
+void GLState::InvalidateBuffer(unsigned int target)
+{
+	int slot = BufferSlot(target);
+	if (slot >= 0)
+		s_Buffers[slot] = Unknown;
+}
+
+void GLState::Invalidate()
+{
+	s_Program = Unknown;
+	s_VertexArray = Unknown;
+	for (unsigned int& buffer : s_Buffers)
+		buffer = Unknown;
+	for (IndexedBinding& binding : s_UniformBindings)
+		binding = { Unknown, 0, 0 };
+	s_ActiveTexture = Unknown;
+	for (unsigned int i = 0; i < s_TextureUnitCount; i++)
+	{
+		s_Textures[i] = Unknown;
+		s_TextureTargets[i] = Unknown;
+	}
+	for (unsigned char& capability : s_Capabilities)
+		capability = 0;
+	s_BlendSource = s_BlendDestination = Unknown;
+	s_DepthFunc = s_DepthMask = s_ColorMask = Unknown;
+	s_PrimitiveRestartIndexKnown = false;
+	for (int& value : s_Viewport)
+		value = -1;
+}
+
+void GLState::PrintFrameStats()
+{
+	std::cout << "GL state changes: issued " << s_Stats.Issued << ", skipped " << s_Stats.Skipped << std::endl;
+}
@@ -0,0 +1,461 @@
+
+// GpuHeap.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "GLState.h"
+
+//TLSF(two-level segregated fit) 방식의 offset 할당기. 실제 메모리는 다루지 않고 [0, size) 범위의 offset만 나눠줌.
+//빈 블록을 크기별 bin(상위 5bit 지수 x 하위 3bit 가수 = 256개)에 넣어두고, bitmask로 조건을 만족하는 가장 작은 bin을 바로 찾으므로
+//Allocate/Free 모두 O(1). Free할 때 양옆의 빈 블록과 합침
+class OffsetAllocator
+{
+public:
+	static constexpr uint32_t Invalid = 0xFFFFFFFF;
+
+	struct Stats
+	{
+		uint32_t UsedSize = 0;
+		uint32_t FreeSize = 0;
+		uint32_t LargestFreeBlock = 0;
+		uint32_t FreeBlocks = 0;
+		uint32_t Allocations = 0;
+	};
+private:
+	static constexpr uint32_t MantissaBits = 3;
+	static constexpr uint32_t MantissaValue = 1 << MantissaBits;
+	static constexpr uint32_t MantissaMask = MantissaValue - 1;
+	static constexpr uint32_t TopBinCount = 32;
+	static constexpr uint32_t BinCount = TopBinCount * MantissaValue;
+
+	struct Node
+	{
+		uint32_t Offset = 0;
+		uint32_t Size = 0;
+		uint32_t BinPrev = Invalid; //같은 bin의 빈 블록 목록
+		uint32_t BinNext = Invalid;
+		uint32_t NeighborPrev = Invalid; //주소 순으로 바로 앞/뒤 블록
+		uint32_t NeighborNext = Invalid;
+		bool Used = false;
+	};
+
+	uint32_t m_Size;
+	uint32_t m_FreeSize;
+	uint32_t m_Allocations;
+	uint32_t m_UsedBinsTop; //bit i: m_UsedBins[i]에 빈 블록이 있는 bin이 있음
+	uint8_t m_UsedBins[TopBinCount];
+	uint32_t m_BinHeads[BinCount];
+	std::vector<Node> m_Nodes;
+	std::vector<uint32_t> m_FreeNodes; //재사용할 Node index
+public:
+	OffsetAllocator(uint32_t size);
+
+	uint32_t Allocate(uint32_t size, uint32_t& offset); //Node index 반환(Free에 사용), 공간이 없으면 Invalid
+	void Free(uint32_t node);
+
+	Stats GetStats() const;
+
+	//빈 allocator가 size를 할당할 수 있는 최소 크기. bin은 크기를 올림해서 찾으므로 size보다 클 수 있음(최대 약 1/8). 32bit를 넘으면 0
+	static uint32_t GetMinimumSize(uint32_t size);
+private:
+	static uint32_t ToBinRoundUp(uint32_t size); //size 이상의 블록만 들어있는 bin
+	static uint32_t ToBinRoundDown(uint32_t size); //size를 넣을 bin
+	static uint64_t GetBinSize(uint32_t bin); //bin에 들어가는 가장 작은 크기
+	static uint32_t FindLowestBit(uint32_t mask, uint32_t start); //start 이상에서 가장 낮은 set bit, 없으면 Invalid
+	uint32_t NewNode();
+	uint32_t InsertFree(uint32_t offset, uint32_t size);
+	void RemoveFree(uint32_t node);
+};
+
+//GpuHeap::Allocate가 돌려주는 범위. 이 범위에 담긴 mesh는 같은 page의 다른 mesh와 VAO/버퍼를 공유
+struct GpuHeapAllocation
+{
+	unsigned int Page = OffsetAllocator::Invalid;
+	unsigned int Node = OffsetAllocator::Invalid;
+	unsigned int Offset = 0; //page 버퍼 안의 byte offset
+	unsigned int Size = 0;
+	unsigned int RendererID = 0; //page 버퍼
+
+	inline bool IsValid() const { return Page != OffsetAllocator::Invalid; }
+};
+
+struct GpuHeapStats
+{
+	unsigned int Pages = 0;
+	unsigned int Allocations = 0;
+	size_t UsedBytes = 0;
+	size_t FreeBytes = 0;
+	size_t LargestFreeBlock = 0; //page 하나 안에서 연속된 가장 큰 빈 공간
+	unsigned int FreeBlocks = 0;
+	float Fragmentation = 0.0f; //1 - 가장 큰 빈 블록 / 전체 빈 공간. 0이면 빈 공간이 한 덩어리
+};
+
+//큰 GL 버퍼 몇개(page)를 만들어두고 mesh마다 그 안의 범위를 나눠주는 heap. mesh마다 버퍼를 만들지 않으므로
+//같은 vertex format의 mesh들은 VAO 하나(page당)로 buffer 재바인딩 없이 base vertex/offset만 바꿔서 그릴 수 있음
+//granularity는 할당 단위(byte). vertex heap은 stride로 두면 모든 offset이 stride의 배수가 되어 base vertex = Offset / stride
+class GpuHeap
+{
+private:
+	struct Page
+	{
+		unsigned int RendererID;
+		OffsetAllocator Allocator;
+	};
+
+	std::vector<Page> m_Pages;
+	unsigned int m_PageSize; //byte
+	unsigned int m_Granularity;
+	unsigned int m_Usage;
+public:
+	GpuHeap(unsigned int pageSize = 64 << 20, unsigned int granularity = 16, unsigned int usage = GL_STATIC_DRAW);
+	~GpuHeap();
+
+	GpuHeap(const GpuHeap&) = delete;
+	GpuHeap& operator=(const GpuHeap&) = delete;
+
+	GpuHeapAllocation Allocate(unsigned int size); //기존 page에 공간이 없으면 page를 추가. 그래도 안 되면 IsValid()가 false
+	void Free(const GpuHeapAllocation& allocation);
+	void Upload(const GpuHeapAllocation& allocation, unsigned int offset, const void* data, unsigned int size);
+
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline unsigned int GetRendererID(unsigned int page) const { return m_Pages[page].RendererID; }
+	inline unsigned int GetGranularity() const { return m_Granularity; }
+	GpuHeapStats GetStats() const;
+private:
+	void AddPage(uint32_t units); //granularity 단위 크기
+};
+
+// GpuHeap.cpp
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+	: m_Size{ size }, m_FreeSize{ 0 }, m_Allocations{ 0 }, m_UsedBinsTop{ 0 }, m_UsedBins{}
+{
+	for (uint32_t& head : m_BinHeads)
+		head = Invalid;
+	InsertFree(0, size);
+}
+
+uint32_t OffsetAllocator::ToBinRoundUp(uint32_t size)
+{
+	//size를 (지수, 3bit 가수)의 작은 부동소수로 표현. 버려지는 하위 bit가 있으면 올림
+	if (size < MantissaValue)
+		return size;
+	uint32_t highest = 31 - __builtin_clz(size);
+	uint32_t shift = highest - MantissaBits;
+	uint32_t bin = ((shift + 1) << MantissaBits) + ((size >> shift) & MantissaMask);
+	if (size & ((1u << shift) - 1))
+		bin++; //가수가 넘치면 다음 지수로 자연스럽게 올라감
+	return bin;
+}
+
+uint32_t OffsetAllocator::ToBinRoundDown(uint32_t size)
+{
+	if (size < MantissaValue)
+		return size;
+	uint32_t highest = 31 - __builtin_clz(size);
+	uint32_t shift = highest - MantissaBits;
+	return ((shift + 1) << MantissaBits) + ((size >> shift) & MantissaMask);
+}
+
+uint64_t OffsetAllocator::GetBinSize(uint32_t bin)
+{
+	if (bin < MantissaValue)
+		return bin;
+	uint32_t shift = (bin >> MantissaBits) - 1;
+	return (uint64_t)(MantissaValue | (bin & MantissaMask)) << shift;
+}
+
+uint32_t OffsetAllocator::GetMinimumSize(uint32_t size)
+{
+	//빈 allocator는 블록 하나를 ToBinRoundDown(전체 크기) bin에 넣고, Allocate는 ToBinRoundUp(size) 이상의 bin만 찾음
+	uint64_t minimum = GetBinSize(ToBinRoundUp(size == 0 ? 1 : size));
+	return minimum > 0xFFFFFFFFull ? 0 : (uint32_t)minimum;
+}
+
+uint32_t OffsetAllocator::FindLowestBit(uint32_t mask, uint32_t start)
+{
+	if (start >= 32)
+		return Invalid;
+	mask &= ~0u << start;
+	return mask ? __builtin_ctz(mask) : Invalid;
+}
+
+uint32_t OffsetAllocator::NewNode()
+{
+	if (!m_FreeNodes.empty())
+	{
+		uint32_t node = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+		m_Nodes[node] = Node{};
+		return node;
+	}
+	m_Nodes.emplace_back();
+	return (uint32_t)m_Nodes.size() - 1;
+}
+
+uint32_t OffsetAllocator::InsertFree(uint32_t offset, uint32_t size)
+{
+	uint32_t bin = ToBinRoundDown(size);
+	uint32_t top = bin >> MantissaBits;
+	m_UsedBinsTop |= 1u << top;
+	m_UsedBins[top] |= 1u << (bin & MantissaMask);
+
+	uint32_t node = NewNode();
+	Node& n = m_Nodes[node];
+	n.Offset = offset;
+	n.Size = size;
+	n.BinNext = m_BinHeads[bin];
+	if (n.BinNext != Invalid)
+		m_Nodes[n.BinNext].BinPrev = node;
+	m_BinHeads[bin] = node;
+	m_FreeSize += size;
+	return node;
+}
+
+void OffsetAllocator::RemoveFree(uint32_t node)
+{
+	Node& n = m_Nodes[node];
+	if (n.BinPrev != Invalid)
+		m_Nodes[n.BinPrev].BinNext = n.BinNext;
+	else
+	{
+		//bin의 첫 블록이었음. bin이 비면 bitmask도 정리
+		uint32_t bin = ToBinRoundDown(n.Size);
+		m_BinHeads[bin] = n.BinNext;
+		if (n.BinNext == Invalid)
+		{
+			uint32_t top = bin >> MantissaBits;
+			m_UsedBins[top] &= ~(1u << (bin & MantissaMask));
+			if (m_UsedBins[top] == 0)
+				m_UsedBinsTop &= ~(1u << top);
+		}
+	}
+	if (n.BinNext != Invalid)
+		m_Nodes[n.BinNext].BinPrev = n.BinPrev;
+	n.BinPrev = n.BinNext = Invalid;
+	m_FreeSize -= n.Size;
+}
+
+uint32_t OffsetAllocator::Allocate(uint32_t size, uint32_t& offset)
+{
+	if (size == 0)
+		size = 1;
+
+	//size 이상인 블록만 있는 bin 중 가장 작은 bin
+	uint32_t minBin = ToBinRoundUp(size);
+	uint32_t top = minBin >> MantissaBits;
+	uint32_t bin = Invalid;
+	if (top < TopBinCount)
+	{
+		uint32_t leaf = FindLowestBit(m_UsedBins[top], minBin & MantissaMask);
+		if (leaf != Invalid)
+			bin = (top << MantissaBits) + leaf;
+		else
+		{
+			top = FindLowestBit(m_UsedBinsTop, top + 1);
+			if (top != Invalid)
+				bin = (top << MantissaBits) + __builtin_ctz(m_UsedBins[top]);
+		}
+	}
+	if (bin == Invalid)
+		return Invalid;
+
+	uint32_t node = m_BinHeads[bin];
+	RemoveFree(node);
+
+	//남는 부분은 새 빈 블록으로 만들어 바로 뒤에 연결
+	uint32_t remainder = m_Nodes[node].Size - size;
+	if (remainder > 0)
+	{
+		uint32_t next = InsertFree(m_Nodes[node].Offset + size, remainder);
+		Node& n = m_Nodes[node]; //InsertFree에서 m_Nodes가 재할당될 수 있음
+		Node& r = m_Nodes[next];
+		r.NeighborPrev = node;
+		r.NeighborNext = n.NeighborNext;
+		if (n.NeighborNext != Invalid)
+			m_Nodes[n.NeighborNext].NeighborPrev = next;
+		n.NeighborNext = next;
+		n.Size = size;
+	}
+
+	m_Nodes[node].Used = true;
+	m_Allocations++;
+	offset = m_Nodes[node].Offset;
+	return node;
+}
+
+void OffsetAllocator::Free(uint32_t node)
+{
+	if (node >= m_Nodes.size() || !m_Nodes[node].Used)
+	{
+		std::cout << "Warning: OffsetAllocator::Free invalid node " << node << "\n";
+		return;
+	}
+
+	uint32_t offset = m_Nodes[node].Offset;
+	uint32_t size = m_Nodes[node].Size;
+	uint32_t prev = m_Nodes[node].NeighborPrev;
+	uint32_t next = m_Nodes[node].NeighborNext;
+
+	//앞/뒤 블록이 비어있으면 하나로 합침
+	if (prev != Invalid && !m_Nodes[prev].Used)
+	{
+		offset = m_Nodes[prev].Offset;
+		size += m_Nodes[prev].Size;
+		RemoveFree(prev);
+		uint32_t before = m_Nodes[prev].NeighborPrev;
+		m_FreeNodes.push_back(prev);
+		prev = before;
+	}
+	if (next != Invalid && !m_Nodes[next].Used)
+	{
+		size += m_Nodes[next].Size;
+		RemoveFree(next);
+		uint32_t after = m_Nodes[next].NeighborNext;
+		m_FreeNodes.push_back(next);
+		next = after;
+	}
+	m_FreeNodes.push_back(node);
+	m_Allocations--;
+
+	uint32_t merged = InsertFree(offset, size);
+	m_Nodes[merged].NeighborPrev = prev;
+	m_Nodes[merged].NeighborNext = next;
+	if (prev != Invalid)
+		m_Nodes[prev].NeighborNext = merged;
+	if (next != Invalid)
+		m_Nodes[next].NeighborPrev = merged;
+}
+
+OffsetAllocator::Stats OffsetAllocator::GetStats() const
+{
+	Stats stats;
+	stats.FreeSize = m_FreeSize;
+	stats.UsedSize = m_Size - m_FreeSize;
+	stats.Allocations = m_Allocations;
+	for (uint32_t bin = 0; bin < BinCount; bin++)
+	{
+		for (uint32_t node = m_BinHeads[bin]; node != Invalid; node = m_Nodes[node].BinNext)
+		{
+			stats.FreeBlocks++;
+			if (m_Nodes[node].Size > stats.LargestFreeBlock)
+				stats.LargestFreeBlock = m_Nodes[node].Size;
+		}
+	}
+	return stats;
+}
+
+
+GpuHeap::GpuHeap(unsigned int pageSize, unsigned int granularity, unsigned int usage)
+	: m_PageSize{ pageSize }, m_Granularity{ granularity > 0 ? granularity : 1 }, m_Usage{ usage }
+{
+}
+
+GpuHeap::~GpuHeap()
+{
+	for (Page& page : m_Pages)
+	{
+		GLState::OnDeleteBuffer(page.RendererID);
+		glDeleteBuffers(1, &page.RendererID);
+	}
+}
+
+void GpuHeap::AddPage(uint32_t units)
+{
+	Page page{ 0, OffsetAllocator(units) };
+	glGenBuffers(1, &page.RendererID);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, page.RendererID); //VAO의 element buffer 바인딩을 건드리지 않도록 중립적인 target 사용
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)units * m_Granularity, nullptr, m_Usage);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m_Pages.push_back(std::move(page));
+}
+
+GpuHeapAllocation GpuHeap::Allocate(unsigned int size)
+{
+	//allocator는 granularity 단위로 관리
+	uint32_t units = (uint32_t)(((uint64_t)size + m_Granularity - 1) / m_Granularity);
+
+	GpuHeapAllocation allocation;
+	uint32_t offset = 0;
+	uint32_t node = OffsetAllocator::Invalid;
+	unsigned int page = 0;
+	for (; page < m_Pages.size(); page++)
+	{
+		node = m_Pages[page].Allocator.Allocate(units, offset);
+		if (node != OffsetAllocator::Invalid)
+			break;
+	}
+
+	if (node == OffsetAllocator::Invalid)
+	{
+		//모든 page가 부족하면 새 page. 요청이 들어가는 bin의 최소 크기 이상으로 만들어야 새 page에서 반드시 할당됨(page보다 큰 요청은 그 크기만큼의 page)
+		uint32_t required = OffsetAllocator::GetMinimumSize(units);
+		uint64_t pageUnits = std::max<uint64_t>(m_PageSize / m_Granularity, required);
+		if (required == 0 || pageUnits * m_Granularity > 0xFFFFFFFFull)
+		{
+			std::cout << "Warning: GpuHeap::Allocate size too large(" << size << " bytes)\n";
+			return allocation;
+		}
+		AddPage((uint32_t)pageUnits);
+		page = (unsigned int)m_Pages.size() - 1;
+		node = m_Pages[page].Allocator.Allocate(units, offset); //새 page에서 한 번만 시도
+		if (node == OffsetAllocator::Invalid)
+		{
+			std::cout << "Warning: GpuHeap::Allocate failed on a new page(" << size << " bytes)\n";
+			return allocation;
+		}
+	}
+
+	allocation.Page = page;
+	allocation.Node = node;
+	allocation.Offset = offset * m_Granularity;
+	allocation.Size = size;
+	allocation.RendererID = m_Pages[page].RendererID;
+	return allocation;
+}
+
+void GpuHeap::Free(const GpuHeapAllocation& allocation)
+{
+	if (!allocation.IsValid() || allocation.Page >= m_Pages.size())
+		return;
+	m_Pages[allocation.Page].Allocator.Free(allocation.Node);
+}
+
+void GpuHeap::Upload(const GpuHeapAllocation& allocation, unsigned int offset, const void* data, unsigned int size)
+{
+	if (!allocation.IsValid() || offset + size > allocation.Size)
+	{
+		std::cout << "Warning: GpuHeap::Upload out of range(" << offset << " + " << size << " > " << allocation.Size << ")\n";
+		return;
+	}
+
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, allocation.RendererID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.Offset + offset, size, data);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GpuHeapStats GpuHeap::GetStats() const
+{
+	GpuHeapStats stats;
+	stats.Pages = (unsigned int)m_Pages.size();
+	for (const Page& page : m_Pages)
+	{
+		OffsetAllocator::Stats pageStats = page.Allocator.GetStats();
+		stats.Allocations += pageStats.Allocations;
+		stats.UsedBytes += (size_t)pageStats.UsedSize * m_Granularity;
+		stats.FreeBytes += (size_t)pageStats.FreeSize * m_Granularity;
+		stats.FreeBlocks += pageStats.FreeBlocks;
+		if ((size_t)pageStats.LargestFreeBlock * m_Granularity > stats.LargestFreeBlock)
+			stats.LargestFreeBlock = (size_t)pageStats.LargestFreeBlock * m_Granularity;
+	}
+	if (stats.FreeBytes > 0)
+		stats.Fragmentation = 1.0f - (float)stats.LargestFreeBlock / stats.FreeBytes;
+	return stats;
+}
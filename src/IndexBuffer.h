@@ -0,0 +1,218 @@
+
+// IndexBuffer.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <type_traits>
+#include <assert.h>
+
+#include "GLState.h"
+#include "RingBuffer.h"
+#include "GpuHeap.h"
+
+//어떤 정수 타입의 index든 받아서, 가장 큰 index가 들어가는 가장 작은 타입(8/16/32bit)으로 저장함.
+//vertex가 65536개 미만인 mesh는 16bit가 되어 index 메모리/대역폭이 절반이 됨. draw할 때는 GetType()을 사용
+//
+//primitive restart: strip 같은 mesh에서 입력 타입의 최대값(-1, 0xFFFF 등)을 restart 표시로 사용.
+//저장 타입의 최대값으로 바뀌어 저장되고, draw 전에 BindPrimitiveRestart()로 GL 상태를 맞춰줌
+class IndexBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Count;
+	unsigned int m_Type; //GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT
+	unsigned int m_SavedBytes; //32bit로 저장했을 때보다 줄어든 크기
+	bool m_PrimitiveRestart;
+	bool m_Owned; //RingBuffer를 감싼 경우 버퍼를 삭제하지 않음
+	GpuHeap* m_Heap; //GpuHeap 안에 있으면 그 heap과 범위
+	GpuHeapAllocation m_Allocation;
+
+	inline static bool s_AllowByteIndices = true;
+public:
+	//count는 갯수(size와 다름)
+	template<typename T>
+	IndexBuffer(const T* data, unsigned int count, bool primitiveRestart = false)
+		: IndexBuffer(nullptr, data, sizeof(T), count, primitiveRestart)
+	{
+		static_assert(std::is_integral_v<T>, "index must be an integer type");
+	}
+	//heap의 page 버퍼 안에 범위를 할당해서 사용. glDrawElementsBaseVertex의 indices 인자에 (void*)GetOffset()을 넘김
+	//offset이 index 크기에 맞도록 heap의 granularity는 4의 배수로 둠
+	template<typename T>
+	IndexBuffer(GpuHeap& heap, const T* data, unsigned int count, bool primitiveRestart = false)
+		: IndexBuffer(&heap, data, sizeof(T), count, primitiveRestart)
+	{
+		static_assert(std::is_integral_v<T>, "index must be an integer type");
+	}
+	//RingBuffer를 index buffer로 사용(소유하지 않음). index는 ring.Allocate()로 쓰고, glDrawElements의 indices 인자에 (void*)Offset을 넘김
+	explicit IndexBuffer(const RingBuffer& ring, unsigned int type = GL_UNSIGNED_INT);
+	~IndexBuffer();
+
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+	void Bind() const;
+	void Unbind() const;
+	void BindPrimitiveRestart() const; //이 버퍼의 restart 설정에 맞게 GL_PRIMITIVE_RESTART를 켜거나 끔
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetType() const { return m_Type; }
+	inline unsigned int GetIndexSize() const { return GetTypeSize(m_Type); }
+	inline unsigned int GetSize() const { return m_Count * GetIndexSize(); }
+	inline unsigned int GetSavedBytes() const { return m_SavedBytes; }
+	inline bool UsesPrimitiveRestart() const { return m_PrimitiveRestart; }
+	inline unsigned int GetRestartIndex() const { return GetMaxIndex(m_Type); }
+	inline unsigned int GetOffset() const { return m_Allocation.Offset; } //버퍼 안에서 index가 시작하는 byte 위치(자기 버퍼면 0)
+
+	//일부 드라이버는 8bit index를 내부에서 16bit로 변환하므로 끌 수 있게 함
+	static void SetAllowByteIndices(bool allow) { s_AllowByteIndices = allow; }
+	static unsigned int GetTypeSize(unsigned int type);
+	static unsigned int GetMaxIndex(unsigned int type);
+private:
+	IndexBuffer(GpuHeap* heap, const void* data, unsigned int sourceSize, unsigned int count, bool primitiveRestart);
+};
+
+// IndexBuffer.cpp
+
+IndexBuffer::IndexBuffer(GpuHeap* heap, const void* data, unsigned int sourceSize, unsigned int count, bool primitiveRestart)
+	: m_RendererID{ 0 }, m_Count{ count }, m_Type{ GL_UNSIGNED_INT }, m_SavedBytes{ 0 }, m_PrimitiveRestart{ primitiveRestart },
+	m_Owned{ heap == nullptr }, m_Heap{ heap }
+{
+	assert(sizeof(unsigned int) == sizeof(GLuint) && "if false, stop here");
+
+	//입력 타입 크기와 상관없이 unsigned로 읽음. 입력 타입의 최대값(모든 bit가 1)은 restart 표시
+	auto read = [&](unsigned int i) -> unsigned int
+	{
+		switch (sourceSize)
+		{
+			case 1: return ((const unsigned char*)data)[i];
+			case 2: return ((const unsigned short*)data)[i];
+			case 4: return ((const unsigned int*)data)[i];
+		}
+		return (unsigned int)((const unsigned long long*)data)[i]; //64bit index는 32bit로 잘라서 사용
+	};
+	unsigned int sourceRestart = sourceSize >= 4 ? 0xFFFFFFFFu : (1u << (sourceSize * 8)) - 1;
+
+	//restart 값을 제외한 가장 큰 index가 들어가는 타입. restart를 쓰면 그 타입의 최대값은 restart 전용이므로 쓸 수 없음
+	unsigned int maxIndex = 0;
+	if (data)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			unsigned int index = read(i);
+			if (!(primitiveRestart && index == sourceRestart) && index > maxIndex)
+				maxIndex = index;
+		}
+	}
+	else
+		maxIndex = 0xFFFFFFFFu; //데이터 없이 공간만 만들면 32bit
+
+	unsigned long long required = (unsigned long long)maxIndex + (primitiveRestart ? 1 : 0);
+	if (s_AllowByteIndices && required <= 0xFF)
+		m_Type = GL_UNSIGNED_BYTE;
+	else if (required <= 0xFFFF)
+		m_Type = GL_UNSIGNED_SHORT;
+	else
+		m_Type = GL_UNSIGNED_INT;
+
+	unsigned int indexSize = GetTypeSize(m_Type);
+	unsigned int restart = GetMaxIndex(m_Type);
+	std::vector<unsigned char> converted;
+	if (data)
+	{
+		converted.resize((size_t)count * indexSize);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			unsigned int index = read(i);
+			if (primitiveRestart && index == sourceRestart)
+				index = restart;
+			switch (indexSize)
+			{
+				case 1: converted[i] = (unsigned char)index; break;
+				case 2: ((unsigned short*)converted.data())[i] = (unsigned short)index; break;
+				default: ((unsigned int*)converted.data())[i] = index; break;
+			}
+		}
+	}
+	m_SavedBytes = count * (4 - indexSize);
+
+	unsigned int size = count * indexSize;
+	if (m_Heap)
+	{
+		m_Allocation = m_Heap->Allocate(size);
+		m_RendererID = m_Allocation.RendererID;
+		if (data)
+			m_Heap->Upload(m_Allocation, 0, converted.data(), size);
+		return;
+	}
+
+	glGenBuffers(1, &m_RendererID); //1. 버퍼 생성
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //2. 바인딩("작업 상태")
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data ? converted.data() : nullptr, GL_STATIC_DRAW);  //3. 작업 상태 버퍼에 데이터 전달
+}
+
+IndexBuffer::IndexBuffer(const RingBuffer& ring, unsigned int type)
+	: m_RendererID{ ring.GetRendererID() }, m_Count{ 0 }, m_Type{ type }, m_SavedBytes{ 0 }, m_PrimitiveRestart{ false },
+	m_Owned{ false }, m_Heap{ nullptr } //개수는 frame마다 달라지므로 draw할 때 직접 지정
+{
+}
+
+IndexBuffer::~IndexBuffer()
+{
+	if (m_Heap)
+		m_Heap->Free(m_Allocation);
+	else if (m_Owned)
+	{
+		GLState::OnDeleteBuffer(m_RendererID);
+		glDeleteBuffers(1, &m_RendererID);
+	}
+}
+
+unsigned int IndexBuffer::GetTypeSize(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE: return 1;
+		case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT: return 4;
+	}
+	assert(0);
+	return 0;
+}
+
+unsigned int IndexBuffer::GetMaxIndex(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE: return 0xFF;
+		case GL_UNSIGNED_SHORT: return 0xFFFF;
+	}
+	return 0xFFFFFFFF;
+}
+
+void IndexBuffer::Bind() const
+{
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //바인딩("작업 상태")
+}
+
+void IndexBuffer::Unbind() const
+{
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); //언바인딩
+}
+
+void IndexBuffer::BindPrimitiveRestart() const
+{
+	//GL_PRIMITIVE_RESTART_FIXED_INDEX(GL 4.3)는 타입의 최대값을 자동으로 쓰지만, 3.3에서도 동작하도록 index를 직접 지정
+	if (m_PrimitiveRestart)
+	{
+		GLState::Enable(GL_PRIMITIVE_RESTART);
+		GLState::PrimitiveRestartIndex(GetRestartIndex());
+	}
+	else
+		GLState::Disable(GL_PRIMITIVE_RESTART);
+}
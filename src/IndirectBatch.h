@@ -0,0 +1,243 @@
+
+// IndirectBatch.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <assert.h>
+
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "VertexArray.h"
+
+//glMultiDrawElementsIndirect가 읽는 draw 하나의 형식(GL 규격 그대로, 20 byte)
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count; //index 수
+	unsigned int InstanceCount;
+	unsigned int FirstIndex; //index 버퍼 안에서 시작 index(byte가 아니라 index 단위)
+	int BaseVertex;
+	unsigned int BaseInstance; //draw 번호. draw ID stream의 이 위치를 읽게 됨
+};
+
+//Submit 한 번의 결과
+struct IndirectBatchStats
+{
+	unsigned int Draws = 0; //Add한 mesh 수
+	unsigned int Runs = 0; //vertex/index 버퍼가 같은 구간 수(구간마다 multi-draw 한 번)
+	unsigned int DrawCalls = 0; //실제 draw 호출 수(multi-draw면 Runs, fallback이면 Draws)
+	unsigned int UploadBytes = 0; //command + per-draw data 업로드 크기
+};
+
+//vertex 형식이 같은 mesh 여러 개를 한 번의 glMultiDrawElementsIndirect로 그림.
+//mesh들은 GpuHeap의 같은 page(vertex/index 버퍼 하나)에 있어야 한 번에 그려지고, page가 바뀔 때마다 multi-draw를 하나 더 호출함.
+//material별로 batch 하나(또는 Clear 후 재사용)를 두면 driver 호출은 material당 상수 번
+//
+//per-draw data(transform, color 등)는 draw 순서대로 버퍼 하나에 모아 올림
+//  - multi-draw 경로(ARB_multi_draw_indirect + ARB_shader_storage_buffer_object + ARB_base_instance):
+//    SSBO(dataBinding)에 배열로 bind. BaseInstance = draw 번호이고, draw ID stream(instance마다 float 하나, DrawIDBinding)이
+//    그 값을 읽으므로 shader는 u_Draws[int(drawID)]로 읽음(ARB_shader_draw_parameters의 gl_DrawIDARB/gl_BaseInstanceARB가 있으면 그걸 써도 됨)
+//  - fallback(위 확장이 없을 때): draw마다 uniform block(dataBinding)에 그 draw의 범위를 bind하고 glDrawElementsBaseVertex
+//  shader 예: res/shaders/IndirectBatch.shader(#feature MULTI_DRAW를 IsMultiDraw()에 맞춰 켬)
+//
+//  VertexArray& va = cache.Get({ &meshLayout, &IndirectBatch::GetDrawIDLayout() }); //mesh stream = binding 0, draw ID = binding 1
+//  batch.Clear();
+//  batch.Add(mesh.vb, mesh.ib, &drawData); ...
+//  batch.Submit(va, 0);
+class IndirectBatch
+{
+private:
+	struct Run
+	{
+		const VertexBuffer* Vertices;
+		const IndexBuffer* Indices;
+		unsigned int First; //m_Commands에서의 시작 위치
+		unsigned int Count;
+	};
+
+	unsigned int m_Stride; //mesh vertex의 byte 크기(base vertex 계산용)
+	unsigned int m_MaxDraws;
+	unsigned int m_DataSize; //draw 하나의 per-draw data 크기
+	unsigned int m_DataStride; //버퍼 안에서 draw 간 간격(multi-draw면 m_DataSize, fallback이면 UBO offset alignment로 올림)
+	bool m_MultiDraw;
+	unsigned int m_CommandBuffer;
+	unsigned int m_DataBuffer;
+	std::unique_ptr<VertexBuffer> m_DrawIDs; //0, 1, 2, ... (float)
+
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	std::vector<unsigned char> m_Data;
+	std::vector<Run> m_Runs;
+	IndirectBatchStats m_Stats;
+public:
+	static constexpr unsigned int MeshBinding = 0;
+	static constexpr unsigned int DrawIDBinding = 1;
+
+	//dataSize는 std430/std140 배열 원소 크기와 같도록 16의 배수(vec4/mat4를 가진 구조체)
+	IndirectBatch(const VertexBufferLayout& meshLayout, unsigned int maxDraws, unsigned int dataSize);
+	~IndirectBatch();
+
+	IndirectBatch(const IndirectBatch&) = delete;
+	IndirectBatch& operator=(const IndirectBatch&) = delete;
+
+	void Clear();
+	//mesh 하나를 추가. data는 dataSize byte(nullptr이면 0으로 채움). maxDraws를 넘으면 false
+	bool Add(const VertexBuffer& vb, const IndexBuffer& ib, const void* data);
+	//va는 GetDrawIDLayout()을 DrawIDBinding에 포함한 SetFormat(VertexArrayCache) VAO. 호출 전에 shader가 bind되어 있어야 함
+	void Submit(VertexArray& va, unsigned int dataBinding);
+
+	inline bool IsMultiDraw() const { return m_MultiDraw; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+	inline const IndirectBatchStats& GetStats() const { return m_Stats; }
+
+	static bool IsMultiDrawSupported();
+	static const VertexBufferLayout& GetDrawIDLayout(); //float 하나, divisor 1
+};
+
+// IndirectBatch.cpp
+
+IndirectBatch::IndirectBatch(const VertexBufferLayout& meshLayout, unsigned int maxDraws, unsigned int dataSize)
+	: m_Stride{ meshLayout.GetStride() }, m_MaxDraws{ maxDraws }, m_DataSize{ dataSize }, m_DataStride{ dataSize },
+	m_MultiDraw{ IsMultiDrawSupported() }, m_CommandBuffer{ 0 }, m_DataBuffer{ 0 }
+{
+	assert(dataSize % 16 == 0 && "per-draw data size must be a multiple of 16 (std430/std140 array stride)");
+	if (!m_MultiDraw)
+	{
+		int alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment > 0)
+			m_DataStride = (dataSize + alignment - 1) / alignment * alignment;
+	}
+
+	std::vector<float> drawIDs(maxDraws);
+	for (unsigned int i = 0; i < maxDraws; i++)
+		drawIDs[i] = (float)i; //2^24까지 정확
+	m_DrawIDs = std::make_unique<VertexBuffer>(drawIDs.data(), (unsigned int)(maxDraws * sizeof(float)));
+
+	if (m_MultiDraw)
+	{
+		glGenBuffers(1, &m_CommandBuffer);
+		GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)maxDraws * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+	}
+	glGenBuffers(1, &m_DataBuffer);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_DataBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)maxDraws * m_DataStride, nullptr, GL_STREAM_DRAW);
+
+	m_Commands.reserve(maxDraws);
+	m_Data.reserve((size_t)maxDraws * m_DataStride);
+}
+
+IndirectBatch::~IndirectBatch()
+{
+	if (m_CommandBuffer)
+	{
+		GLState::OnDeleteBuffer(m_CommandBuffer);
+		glDeleteBuffers(1, &m_CommandBuffer);
+	}
+	GLState::OnDeleteBuffer(m_DataBuffer);
+	glDeleteBuffers(1, &m_DataBuffer);
+}
+
+bool IndirectBatch::IsMultiDrawSupported()
+{
+	return GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_base_instance;
+}
+
+const VertexBufferLayout& IndirectBatch::GetDrawIDLayout()
+{
+	static VertexBufferLayout layout = []()
+	{
+		VertexBufferLayout drawID;
+		drawID.Push<float>(1);
+		drawID.SetDivisor(1);
+		return drawID;
+	}();
+	return layout;
+}
+
+void IndirectBatch::Clear()
+{
+	m_Commands.clear();
+	m_Data.clear();
+	m_Runs.clear();
+	m_Stats = IndirectBatchStats{};
+}
+
+bool IndirectBatch::Add(const VertexBuffer& vb, const IndexBuffer& ib, const void* data)
+{
+	if (m_Commands.size() >= m_MaxDraws)
+	{
+		std::cout << "Warning: IndirectBatch is full(" << m_MaxDraws << " draws)\n";
+		return false;
+	}
+
+	unsigned int draw = (unsigned int)m_Commands.size();
+	m_Commands.push_back({ ib.GetCount(), 1, ib.GetOffset() / ib.GetIndexSize(), vb.GetBaseVertex(m_Stride), draw });
+
+	m_Data.resize((size_t)(draw + 1) * m_DataStride, 0);
+	if (data)
+		std::memcpy(m_Data.data() + (size_t)draw * m_DataStride, data, m_DataSize);
+
+	//버퍼가 같으면 같은 multi-draw에 넣음(index 타입은 버퍼마다 하나)
+	if (m_Runs.empty() || m_Runs.back().Vertices->GetRendererID() != vb.GetRendererID() || m_Runs.back().Indices->GetRendererID() != ib.GetRendererID()
+		|| m_Runs.back().Indices->GetType() != ib.GetType())
+		m_Runs.push_back({ &vb, &ib, draw, 0 });
+	m_Runs.back().Count++;
+	return true;
+}
+
+void IndirectBatch::Submit(VertexArray& va, unsigned int dataBinding)
+{
+	unsigned int drawCount = (unsigned int)m_Commands.size();
+	m_Stats.Draws = drawCount;
+	m_Stats.Runs = (unsigned int)m_Runs.size();
+	if (drawCount == 0)
+		return;
+
+	//이번 Submit의 command/data를 새 저장소에 올림(이전 Submit을 GPU가 읽는 중이어도 기다리지 않음)
+	unsigned int dataBytes = drawCount * m_DataStride;
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_DataBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_MaxDraws * m_DataStride, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, 0, dataBytes, m_Data.data());
+	m_Stats.UploadBytes += dataBytes;
+	if (m_MultiDraw)
+	{
+		unsigned int commandBytes = drawCount * sizeof(DrawElementsIndirectCommand);
+		GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)m_MaxDraws * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandBytes, m_Commands.data());
+		m_Stats.UploadBytes += commandBytes;
+		GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, dataBinding, m_DataBuffer, 0, dataBytes);
+	}
+
+	va.Bind();
+	va.BindVertexBuffer(DrawIDBinding, *m_DrawIDs);
+	for (const Run& run : m_Runs)
+	{
+		va.BindVertexBuffer(MeshBinding, *run.Vertices);
+		va.BindIndexBuffer(*run.Indices);
+		unsigned int type = run.Indices->GetType();
+		if (m_MultiDraw)
+		{
+			glMultiDrawElementsIndirect(GL_TRIANGLES, type, (const void*)(size_t)(run.First * sizeof(DrawElementsIndirectCommand)), run.Count, 0);
+			m_Stats.DrawCalls++;
+			continue;
+		}
+
+		unsigned int indexSize = run.Indices->GetIndexSize();
+		for (unsigned int i = run.First; i < run.First + run.Count; i++)
+		{
+			const DrawElementsIndirectCommand& command = m_Commands[i];
+			GLState::BindBufferRange(GL_UNIFORM_BUFFER, dataBinding, m_DataBuffer, i * m_DataStride, m_DataSize);
+			glDrawElementsBaseVertex(GL_TRIANGLES, command.Count, type, (const void*)(size_t)(command.FirstIndex * indexSize), command.BaseVertex);
+			m_Stats.DrawCalls++;
+		}
+	}
+}
@@ -0,0 +1,403 @@
+
+// MeshOptimizer.h
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+//post-transform vertex cache 시뮬레이션 결과(FIFO)
+//ACMR: 삼각형당 vertex shader 실행 수(0.5~3, 낮을수록 좋음), ATVR: vertex당 실행 수(1이 최선)
+struct VertexCacheStats
+{
+	float ACMR = 0.0f;
+	float ATVR = 0.0f;
+};
+
+//vertex buffer를 읽을 때 cache line(64 byte) 단위로 실제로 가져온 양
+//Overfetch: 가져온 byte / vertex buffer 크기(1이 최선)
+struct VertexFetchStats
+{
+	size_t BytesFetched = 0;
+	float Overfetch = 0.0f;
+};
+
+//각 단계 전후의 결과
+struct MeshOptimizeReport
+{
+	VertexCacheStats Before;
+	VertexCacheStats After;
+	VertexFetchStats FetchBefore; //OptimizeVertexFetch에서만 채움
+	VertexFetchStats FetchAfter;
+};
+
+//업로드 전에(로딩 시 또는 오프라인으로) index/vertex 순서를 GPU에 유리하게 바꾸는 단계들. 보통 아래 순서로 실행
+//  1. OptimizeVertexCache: 최근에 쓴 vertex를 다시 쓰는 삼각형을 먼저 그리도록 index 재배열(Forsyth)
+//  2. OptimizeOverdraw: 1의 결과를 cache 효율이 크게 나빠지지 않는 경계에서 cluster로 나누고, 바깥을 향하는 cluster를 먼저 그리도록 정렬
+//  3. OptimizeVertexFetch: vertex를 index에서 처음 사용되는 순서로 재배열해서 vertex buffer를 앞에서부터 읽게 함(index도 다시 매핑)
+//모든 함수는 삼각형 목록(GL_TRIANGLES) index를 제자리에서 수정함
+class MeshOptimizer
+{
+public:
+	static MeshOptimizeReport OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+	//positions: vertex마다 float 3개(x, y, z)가 있는 위치, stride는 byte 단위. threshold: cluster로 나눈 뒤 허용하는 ACMR 증가 비율
+	static MeshOptimizeReport OptimizeOverdraw(std::vector<unsigned int>& indices, const float* positions, unsigned int positionStride,
+		unsigned int vertexCount, float threshold = 1.05f);
+	//vertices의 순서를 바꾸고 사용되지 않는 vertex는 제거. 새 vertex 수를 반환(vertices는 그 크기까지만 유효)
+	static unsigned int OptimizeVertexFetch(std::vector<unsigned int>& indices, void* vertices, unsigned int vertexCount,
+		unsigned int vertexSize, MeshOptimizeReport* report = nullptr);
+
+	static VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+	static VertexFetchStats AnalyzeVertexFetch(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int vertexSize);
+	static void PrintReport(const char* stage, const MeshOptimizeReport& report);
+private:
+	static constexpr unsigned int s_CacheSize = 32; //Forsyth 알고리즘이 가정하는 LRU cache 크기
+	static float VertexScore(int cachePosition, unsigned int remainingTriangles);
+};
+
+// MeshOptimizer.cpp
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+	//FIFO cache: 요즘 GPU는 정확히 FIFO는 아니지만, 상대적인 비교에는 충분
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	unsigned int misses = 0;
+	for (unsigned int index : indices)
+	{
+		if (index >= vertexCount)
+			continue;
+		if (time - timestamps[index] > cacheSize)
+		{
+			timestamps[index] = time++;
+			misses++;
+		}
+	}
+
+	VertexCacheStats stats;
+	size_t triangles = indices.size() / 3;
+	if (triangles > 0)
+		stats.ACMR = (float)misses / triangles;
+	if (vertexCount > 0)
+		stats.ATVR = (float)misses / vertexCount;
+	return stats;
+}
+
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int vertexSize)
+{
+	//vertex 하나를 읽을 때 걸치는 cache line을 작은 direct-mapped cache(64 byte x 64줄)로 시뮬레이션
+	const unsigned int lineSize = 64, lineCount = 64;
+	std::vector<size_t> lines(lineCount, (size_t)-1);
+	VertexFetchStats stats;
+	for (unsigned int index : indices)
+	{
+		if (index >= vertexCount)
+			continue;
+		size_t first = (size_t)index * vertexSize / lineSize;
+		size_t last = ((size_t)index * vertexSize + vertexSize - 1) / lineSize;
+		for (size_t line = first; line <= last; line++)
+		{
+			if (lines[line % lineCount] != line)
+			{
+				lines[line % lineCount] = line;
+				stats.BytesFetched += lineSize;
+			}
+		}
+	}
+	if (vertexCount > 0 && vertexSize > 0)
+		stats.Overfetch = (float)stats.BytesFetched / ((size_t)vertexCount * vertexSize);
+	return stats;
+}
+
+float MeshOptimizer::VertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	//삼각형 하나를 그릴 때마다 cache 안의 vertex 전부의 점수를 다시 계산하므로 pow/sqrt는 미리 표로 만들어 둠
+	struct Tables
+	{
+		float Cache[s_CacheSize];
+		float Valence[64];
+		Tables()
+		{
+			for (unsigned int i = 0; i < s_CacheSize; i++) //방금 사용한 삼각형의 vertex(0~2)는 같은 삼각형을 다시 고르지 않도록 고정 점수
+				Cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (float)(i - 3) / (s_CacheSize - 3), 1.5f);
+			for (unsigned int i = 1; i < 64; i++)
+				Valence[i] = 2.0f / std::sqrt((float)i);
+		}
+	};
+	static const Tables tables;
+
+	if (remainingTriangles == 0) //더 사용할 삼각형이 없으면 점수 없음
+		return -1.0f;
+
+	float score = cachePosition >= 0 ? tables.Cache[cachePosition] : 0.0f;
+	//남은 삼각형이 적은 vertex를 먼저 끝내서 cache에서 빠지기 전에 다 쓰도록 함
+	return score + (remainingTriangles < 64 ? tables.Valence[remainingTriangles] : 2.0f / std::sqrt((float)remainingTriangles));
+}
+
+MeshOptimizeReport MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount)
+{
+	MeshOptimizeReport report;
+	report.Before = AnalyzeVertexCache(indices, vertexCount);
+
+	unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		report.After = report.Before;
+		return report;
+	}
+
+	//vertex -> 그 vertex를 쓰는 삼각형 목록(CSR 형태)
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (unsigned int i = 0; i < triangleCount * 3; i++)
+		remaining[indices[i]]++;
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+	std::vector<unsigned int> adjacency(adjacencyOffset[vertexCount]);
+	{
+		std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (unsigned int t = 0; t < triangleCount; t++)
+			for (int k = 0; k < 3; k++)
+				adjacency[fill[indices[t * 3 + k]]++] = t;
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		vertexScore[v] = VertexScore(-1, remaining[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (unsigned int t = 0; t < triangleCount; t++)
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	std::vector<unsigned int> cache, nextCache;
+	cache.reserve(s_CacheSize + 3);
+	nextCache.reserve(s_CacheSize + 3);
+	unsigned int scanCursor = 0; //cache에 후보가 없을 때 다음 삼각형을 찾기 시작할 위치
+
+	unsigned int best = 0;
+	float bestScore = triangleScore[0];
+	for (unsigned int t = 1; t < triangleCount; t++)
+	{
+		if (triangleScore[t] > bestScore)
+		{
+			bestScore = triangleScore[t];
+			best = t;
+		}
+	}
+
+	for (unsigned int emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		if (best == 0xFFFFFFFF) //cache 안의 vertex로 만들 수 있는 삼각형이 없으면 아직 안 그린 다음 삼각형부터
+		{
+			while (emitted[scanCursor])
+				scanCursor++;
+			best = scanCursor;
+		}
+
+		emitted[best] = true;
+		const unsigned int* triangle = &indices[best * 3];
+		result.insert(result.end(), triangle, triangle + 3);
+
+		//이 삼각형의 vertex를 LRU cache 앞으로 옮기고, 각 vertex의 인접 목록에서 이 삼각형을 제거
+		nextCache.assign(triangle, triangle + 3);
+		for (unsigned int v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				nextCache.push_back(v);
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int v = triangle[k];
+			unsigned int* begin = &adjacency[adjacencyOffset[v]];
+			unsigned int* end = begin + remaining[v];
+			unsigned int* it = std::find(begin, end, best);
+			if (it != end)
+			{
+				*it = *(end - 1);
+				remaining[v]--;
+			}
+		}
+
+		//cache에서 밀려난 vertex 포함, 위치가 바뀐 vertex의 점수를 갱신하고 그 vertex의 삼각형 점수도 갱신
+		for (unsigned int i = 0; i < nextCache.size(); i++)
+		{
+			unsigned int v = nextCache[i];
+			int position = i < s_CacheSize ? (int)i : -1;
+			cachePosition[v] = position;
+			float score = VertexScore(position, remaining[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v] + remaining[v]; a++)
+				triangleScore[adjacency[a]] += delta;
+		}
+		if (nextCache.size() > s_CacheSize)
+			nextCache.resize(s_CacheSize);
+		cache.swap(nextCache);
+
+		//다음 삼각형은 cache 안의 vertex를 쓰는 삼각형 중에서만 고름(전체를 다시 보지 않음)
+		best = 0xFFFFFFFF;
+		bestScore = -1.0f;
+		for (unsigned int v : cache)
+		{
+			for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v] + remaining[v]; a++)
+			{
+				unsigned int t = adjacency[a];
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+	}
+
+	indices.swap(result);
+	report.After = AnalyzeVertexCache(indices, vertexCount);
+	return report;
+}
+
+MeshOptimizeReport MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const float* positions, unsigned int positionStride,
+	unsigned int vertexCount, float threshold)
+{
+	MeshOptimizeReport report;
+	report.Before = AnalyzeVertexCache(indices, vertexCount);
+
+	unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+	auto position = [&](unsigned int v) { return (const float*)((const char*)positions + (size_t)v * positionStride); };
+
+	//1. cluster 나누기: 삼각형 3개 vertex가 모두 cache miss인 곳(cache가 사실상 비워지는 곳)이 경계 후보.
+	//   지금까지의 cluster ACMR이 전체 ACMR * threshold 이하일 때만 경계로 인정해서 cache 효율을 유지함
+	const unsigned int cacheSize = 16;
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	std::vector<unsigned int> clusters; //각 cluster의 첫 삼각형
+	unsigned int clusterMisses = 0, clusterStart = 0;
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		unsigned int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int v = indices[t * 3 + k];
+			if (time - timestamps[v] > cacheSize)
+			{
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+
+		if (t == 0 || (misses == 3 && t > clusterStart &&
+			(float)clusterMisses / (t - clusterStart) <= report.Before.ACMR * threshold))
+		{
+			clusters.push_back(t);
+			clusterStart = t;
+			clusterMisses = 0;
+		}
+		clusterMisses += misses;
+	}
+	clusters.push_back(triangleCount);
+
+	//2. mesh 중심에서 바깥을 향하는 cluster를 먼저 그림(바깥쪽 면이 먼저 depth를 채우면 안쪽 면의 fragment는 depth test에서 버려짐)
+	float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		for (int c = 0; c < 3; c++)
+			meshCenter[c] += position(v)[c];
+	}
+	for (int c = 0; c < 3; c++)
+		meshCenter[c] /= vertexCount > 0 ? vertexCount : 1;
+
+	struct Cluster { unsigned int First; unsigned int Last; float Sort; };
+	std::vector<Cluster> sorted;
+	for (size_t c = 0; c + 1 < clusters.size(); c++)
+	{
+		//면적 가중 법선과 중심
+		float center[3] = { 0.0f, 0.0f, 0.0f }, normal[3] = { 0.0f, 0.0f, 0.0f }, area = 0.0f;
+		for (unsigned int t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const float* p0 = position(indices[t * 3]);
+			const float* p1 = position(indices[t * 3 + 1]);
+			const float* p2 = position(indices[t * 3 + 2]);
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float a = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (int k = 0; k < 3; k++)
+			{
+				normal[k] += n[k];
+				center[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * a;
+			}
+			area += a;
+		}
+		float sort = 0.0f;
+		if (area > 0.0f)
+		{
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			for (int k = 0; k < 3; k++)
+				sort += (center[k] / area - meshCenter[k]) * (length > 0.0f ? normal[k] / length : 0.0f);
+		}
+		sorted.push_back({ clusters[c], clusters[c + 1], sort });
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.Sort > b.Sort; });
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (const Cluster& cluster : sorted)
+		result.insert(result.end(), indices.begin() + cluster.First * 3, indices.begin() + cluster.Last * 3);
+	result.insert(result.end(), indices.begin() + triangleCount * 3, indices.end()); //3의 배수가 아닌 나머지는 그대로
+
+	indices.swap(result);
+	report.After = AnalyzeVertexCache(indices, vertexCount);
+	return report;
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(std::vector<unsigned int>& indices, void* vertices, unsigned int vertexCount,
+	unsigned int vertexSize, MeshOptimizeReport* report)
+{
+	if (report)
+	{
+		report->Before = AnalyzeVertexCache(indices, vertexCount);
+		report->FetchBefore = AnalyzeVertexFetch(indices, vertexCount, vertexSize);
+	}
+
+	//index에서 처음 나오는 순서대로 새 번호를 붙임
+	std::vector<unsigned int> remap(vertexCount, 0xFFFFFFFF);
+	unsigned int next = 0;
+	for (unsigned int& index : indices)
+	{
+		if (index >= vertexCount)
+			continue;
+		if (remap[index] == 0xFFFFFFFF)
+			remap[index] = next++;
+		index = remap[index];
+	}
+
+	std::vector<unsigned char> copy((const unsigned char*)vertices, (const unsigned char*)vertices + (size_t)vertexCount * vertexSize);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != 0xFFFFFFFF)
+			std::memcpy((unsigned char*)vertices + (size_t)remap[v] * vertexSize, copy.data() + (size_t)v * vertexSize, vertexSize);
+	}
+
+	if (report)
+	{
+		report->After = AnalyzeVertexCache(indices, next);
+		report->FetchAfter = AnalyzeVertexFetch(indices, next, vertexSize);
+	}
+	return next;
+}
+
+void MeshOptimizer::PrintReport(const char* stage, const MeshOptimizeReport& report)
+{
+	std::cout << stage << ": ACMR " << report.Before.ACMR << " -> " << report.After.ACMR
+		<< ", ATVR " << report.Before.ATVR << " -> " << report.After.ATVR;
+	if (report.FetchBefore.BytesFetched > 0)
+		std::cout << ", overfetch " << report.FetchBefore.Overfetch << " -> " << report.FetchAfter.Overfetch;
+	std::cout << std::endl;
+}
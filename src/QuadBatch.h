@@ -0,0 +1,275 @@
+
+// QuadBatch.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+
+#include "res/shaders/Shader.h"
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+
+//quad 하나의 꼭짓점. 24 byte
+struct QuadBatchVertex
+{
+	float Position[2]; //화면 pixel 좌표
+	float TexCoord[2];
+	unsigned char Color[4]; //RGBA8, shader에서는 [0, 1]
+	float TexIndex; //texture slot
+};
+DEFINE_VERTEX_LAYOUT(QuadBatchVertex, VERTEX_ATTRIBUTE(QuadBatchVertex, Position), VERTEX_ATTRIBUTE(QuadBatchVertex, TexCoord),
+	VERTEX_ATTRIBUTE(QuadBatchVertex, Color), VERTEX_ATTRIBUTE(QuadBatchVertex, TexIndex));
+
+//frame 하나의 결과. BeginFrame()에서 초기화
+struct QuadBatchStats
+{
+	unsigned int Quads = 0;
+	unsigned int Flushes = 0; //draw call 수
+	unsigned int TextureFlushes = 0; //texture slot이 모자라서 flush한 수
+	unsigned int CapacityFlushes = 0; //quad 수가 batch 크기를 넘어서 flush한 수
+	unsigned int BytesUploaded = 0;
+};
+
+//2D quad(sprite, UI)를 CPU 배열에 모았다가 한 번의 draw로 그림.
+//index는 quad마다 같은 모양(0 1 2 2 3 0 + 4i)이므로 최대 크기로 한 번만 만들어 두고, vertex만 매 flush마다 VertexBuffer::Stream으로 올림.
+//Stream은 버퍼 뒤쪽 빈 공간에 동기화 없이 쓰므로, 앞서 flush한 vertex를 GPU가 읽는 중이어도 기다리지 않고 base vertex만 바꿔서 그림
+//texture는 batch마다 slot(texture unit) 16개 또는 32개(GL_MAX_TEXTURE_IMAGE_UNITS가 허용하면). slot 0은 흰색 1x1 texture(색만 있는 quad)
+//slot이나 quad 수가 모자라면 자동으로 Flush
+//  batch.SetViewport(width, height);
+//  batch.BeginFrame();
+//  batch.DrawQuad(x, y, w, h, 0xFF3366CC); batch.DrawTexturedQuad(x, y, w, h, texture); ...
+//  batch.Flush(); //frame 끝
+class QuadBatch
+{
+private:
+	unsigned int m_MaxQuads;
+	unsigned int m_TextureSlotCount;
+	Shader m_Shader;
+	int m_ScreenTransformIndex;
+	VertexArray m_VertexArray;
+	VertexBuffer m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	unsigned int m_WhiteTexture;
+
+	std::vector<QuadBatchVertex> m_Vertices; //m_MaxQuads * 4, 처음부터 크기를 잡아두고 m_QuadCount까지만 사용
+	unsigned int m_QuadCount;
+	unsigned int m_Textures[32];
+	unsigned int m_TextureCount;
+	unsigned int m_LastTexture; //바로 전 quad의 texture와 slot(같은 texture가 이어지는 경우 검색 생략)
+	unsigned int m_LastSlot;
+	QuadBatchStats m_Stats;
+public:
+	//maxQuads는 draw 하나에 들어가는 quad 수. 16383 이하면 index가 16bit
+	QuadBatch(unsigned int maxQuads = 16000, const std::string& shaderPath = "res/shaders/QuadBatch.shader");
+	~QuadBatch();
+
+	QuadBatch(const QuadBatch&) = delete;
+	QuadBatch& operator=(const QuadBatch&) = delete;
+
+	//pixel 좌표 -> clip 좌표(왼쪽 위가 (0, 0), y는 아래로)
+	void SetViewport(float width, float height);
+
+	//color는 메모리 순서로 R, G, B, A(little endian에서 0xAABBGGRR)
+	void DrawQuad(float x, float y, float width, float height, uint32_t color);
+	void DrawTexturedQuad(float x, float y, float width, float height, unsigned int texture, uint32_t tint = 0xFFFFFFFF,
+		float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+	void Flush(); //모은 quad를 그림. frame 끝이나 다른 draw 전에 호출
+
+	void BeginFrame(); //frame 통계 초기화
+	inline const QuadBatchStats& GetFrameStats() const { return m_Stats; }
+	void PrintFrameStats() const;
+
+	inline unsigned int GetMaxQuads() const { return m_MaxQuads; }
+	inline unsigned int GetTextureSlotCount() const { return m_TextureSlotCount; }
+private:
+	void ReserveQuad(); //batch가 가득 찼으면 flush
+	unsigned int GetTextureSlot(unsigned int texture);
+	void PushQuad(float x, float y, float width, float height, uint32_t color, float slot, float u0, float v0, float u1, float v1);
+	static unsigned int QueryTextureSlotCount();
+	//slot 수에 맞는 variant로 바로 생성(기본 variant를 먼저 빌드하지 않도록)
+	static Shader CreateShader(const std::string& shaderPath, unsigned int textureSlotCount);
+};
+
+// QuadBatch.cpp
+
+QuadBatch::QuadBatch(unsigned int maxQuads, const std::string& shaderPath)
+	: m_MaxQuads{ maxQuads }, m_TextureSlotCount{ QueryTextureSlotCount() }, m_Shader{ CreateShader(shaderPath, m_TextureSlotCount) }, m_ScreenTransformIndex{ -1 },
+	//Stream은 버퍼 끝에 닿으면 orphan하므로 batch 여러 개 크기로 잡아서 frame 안의 flush 대부분이 orphan 없이 이어서 쓰게 함
+	m_VertexBuffer{ nullptr, (unsigned int)(maxQuads * 4 * sizeof(QuadBatchVertex) * 4), BufferUsage::Stream },
+	m_WhiteTexture{ 0 }, m_QuadCount{ 0 }, m_Textures{}, m_TextureCount{ 1 }, m_LastTexture{ 0 }, m_LastSlot{ 0 }
+{
+	m_Vertices.resize((size_t)maxQuads * 4);
+
+	std::vector<unsigned int> indices((size_t)maxQuads * 6);
+	for (unsigned int i = 0; i < maxQuads; i++)
+	{
+		unsigned int vertex = i * 4;
+		unsigned int* quad = &indices[(size_t)i * 6];
+		quad[0] = vertex; quad[1] = vertex + 1; quad[2] = vertex + 2;
+		quad[3] = vertex + 2; quad[4] = vertex + 3; quad[5] = vertex;
+	}
+	m_VertexArray.AddBuffer<QuadBatchVertex>(m_VertexBuffer); //VAO가 bind된 상태에서 만들어야 index 버퍼가 VAO에 기록됨
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+
+	//slot 0: 흰색 1x1
+	unsigned int white = 0xFFFFFFFF;
+	glGenTextures(1, &m_WhiteTexture);
+	GLState::BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	m_Textures[0] = m_WhiteTexture;
+	m_LastTexture = m_WhiteTexture;
+
+	m_Shader.Bind();
+	//sampler 배열은 한 번만 설정(slot i = texture unit i)
+	int samplers[32];
+	for (int i = 0; i < 32; i++)
+		samplers[i] = i;
+	int location = m_Shader.GetUniformLocation("u_Textures");
+	if (location != -1)
+		glUniform1iv(location, m_TextureSlotCount, samplers);
+	m_ScreenTransformIndex = m_Shader.GetUniformIndex("u_ScreenTransform");
+}
+
+QuadBatch::~QuadBatch()
+{
+	GLState::OnDeleteTexture(m_WhiteTexture);
+	glDeleteTextures(1, &m_WhiteTexture);
+}
+
+unsigned int QuadBatch::QueryTextureSlotCount()
+{
+	int units = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units); //fragment shader에서 쓸 수 있는 수(GL 3.3은 최소 16)
+	return units >= 32 ? 32 : 16;
+}
+
+Shader QuadBatch::CreateShader(const std::string& shaderPath, unsigned int textureSlotCount)
+{
+	ShaderProgramSource source = Shader::ParseShader(shaderPath);
+	uint32_t mask = 0;
+	if (textureSlotCount == 32)
+	{
+		auto it = std::find(source.Features.begin(), source.Features.end(), "TEXTURE_SLOTS_32");
+		if (it != source.Features.end() && it - source.Features.begin() < 32) //Shader::GetFeatureMask와 같은 규칙
+			mask = 1u << (it - source.Features.begin());
+	}
+	return Shader(shaderPath, source, mask);
+}
+
+void QuadBatch::SetViewport(float width, float height)
+{
+	m_Shader.Bind();
+	m_Shader.SetUniform4f(m_ScreenTransformIndex, 2.0f / width, -2.0f / height, -1.0f, 1.0f);
+}
+
+unsigned int QuadBatch::GetTextureSlot(unsigned int texture)
+{
+	if (texture == m_LastTexture)
+		return m_LastSlot;
+
+	unsigned int slot = 0;
+	while (slot < m_TextureCount && m_Textures[slot] != texture)
+		slot++;
+	if (slot == m_TextureCount)
+	{
+		if (m_TextureCount == m_TextureSlotCount) //slot이 모자라면 지금까지 모은 quad를 그리고 처음부터 다시 채움
+		{
+			m_Stats.TextureFlushes++;
+			Flush();
+			slot = m_TextureCount;
+		}
+		m_Textures[m_TextureCount++] = texture;
+	}
+	m_LastTexture = texture;
+	m_LastSlot = slot;
+	return slot;
+}
+
+void QuadBatch::ReserveQuad()
+{
+	if (m_QuadCount == m_MaxQuads)
+	{
+		m_Stats.CapacityFlushes++;
+		Flush();
+	}
+}
+
+void QuadBatch::PushQuad(float x, float y, float width, float height, uint32_t color, float slot, float u0, float v0, float u1, float v1)
+{
+	QuadBatchVertex* vertex = &m_Vertices[(size_t)m_QuadCount * 4];
+	float positions[4][2] = { { x, y }, { x + width, y }, { x + width, y + height }, { x, y + height } };
+	float texCoords[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+	for (int i = 0; i < 4; i++)
+	{
+		vertex[i].Position[0] = positions[i][0];
+		vertex[i].Position[1] = positions[i][1];
+		vertex[i].TexCoord[0] = texCoords[i][0];
+		vertex[i].TexCoord[1] = texCoords[i][1];
+		std::memcpy(vertex[i].Color, &color, 4);
+		vertex[i].TexIndex = slot;
+	}
+	m_QuadCount++;
+	m_Stats.Quads++;
+}
+
+void QuadBatch::DrawQuad(float x, float y, float width, float height, uint32_t color)
+{
+	ReserveQuad();
+	PushQuad(x, y, width, height, color, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+}
+
+void QuadBatch::DrawTexturedQuad(float x, float y, float width, float height, unsigned int texture, uint32_t tint, float u0, float v0, float u1, float v1)
+{
+	//flush는 slot을 정하기 전에 해야 함(flush하면 slot 배정이 처음부터 다시 시작됨)
+	ReserveQuad();
+	float slot = (float)GetTextureSlot(texture);
+	PushQuad(x, y, width, height, tint, slot, u0, v0, u1, v1);
+}
+
+void QuadBatch::Flush()
+{
+	if (m_QuadCount > 0)
+	{
+		unsigned int bytes = m_QuadCount * 4 * sizeof(QuadBatchVertex);
+		unsigned int offset = m_VertexBuffer.Stream(m_Vertices.data(), bytes);
+		int baseVertex = (int)(offset / sizeof(QuadBatchVertex)); //offset은 항상 quad 크기의 배수
+
+		m_Shader.Bind();
+		for (unsigned int slot = 0; slot < m_TextureCount; slot++)
+			GLState::BindTexture(slot, GL_TEXTURE_2D, m_Textures[slot]);
+		m_VertexArray.Bind();
+		m_IndexBuffer->Bind();
+		glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadCount * 6, m_IndexBuffer->GetType(), nullptr, baseVertex);
+
+		m_Stats.Flushes++;
+		m_Stats.BytesUploaded += bytes;
+	}
+
+	m_QuadCount = 0;
+	m_TextureCount = 1; //slot 0(흰색)은 유지
+	m_LastTexture = m_WhiteTexture;
+	m_LastSlot = 0;
+}
+
+void QuadBatch::BeginFrame()
+{
+	m_Stats = QuadBatchStats{};
+}
+
+void QuadBatch::PrintFrameStats() const
+{
+	std::cout << "QuadBatch: " << m_Stats.Quads << " quads, " << m_Stats.Flushes << " draw calls(texture " << m_Stats.TextureFlushes
+		<< ", capacity " << m_Stats.CapacityFlushes << "), " << m_Stats.BytesUploaded / 1024 << " KB uploaded" << std::endl;
+}
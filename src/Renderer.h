@@ -0,0 +1,52 @@
+
+// Renderer.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GLState.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+//draw call 진입점. shader(program)는 호출 전에 bind(Shader::Bind 또는 GLState::UseProgram)되어 있어야 함
+//VAO와 index 버퍼는 GLState를 거쳐 bind하므로 같은 mesh를 이어서 그리면 bind가 생략됨
+//VertexArray::AddBuffer는 attribute를 버퍼의 0 byte부터 가리키므로, GpuHeap page를 공유하는 mesh는 baseVertex로
+//자기 vertex 위치를 넘겨야 함(vb.GetBaseVertex(layout.GetStride())). 자기 버퍼를 가진 mesh는 0
+//draw마다 ib.BindPrimitiveRestart()로 GL_PRIMITIVE_RESTART를 그 버퍼에 맞추므로, restart 표시가 있는 strip mesh는 mode만 GL_TRIANGLE_STRIP 등으로 넘기면 됨
+class Renderer
+{
+public:
+	static void Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int mode = GL_TRIANGLES, int baseVertex = 0);
+	//같은 mesh를 instanceCount번 그림. instance stream(VertexArray::AddInstanceBuffer)의 원소 i와 gl_InstanceID i가 대응
+	//uniform을 바꿔가며 Draw를 instanceCount번 부르는 것과 결과가 같지만, draw call과 uniform 업로드가 한 번으로 줄어듦
+	static void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, unsigned int instanceCount, unsigned int mode = GL_TRIANGLES, int baseVertex = 0);
+};
+
+// Renderer.cpp
+
+void Renderer::Draw(const VertexArray & va, const IndexBuffer & ib, unsigned int mode, int baseVertex)
+{
+	va.Bind();
+	ib.Bind();
+	ib.BindPrimitiveRestart(); //이전 draw의 restart 설정이 남아 있지 않도록 항상 맞춤
+	const void* indices = (const void*)(size_t)ib.GetOffset(); //GpuHeap 안의 index 버퍼면 시작 위치부터
+	if (baseVertex != 0)
+		glDrawElementsBaseVertex(mode, ib.GetCount(), ib.GetType(), indices, baseVertex);
+	else
+		glDrawElements(mode, ib.GetCount(), ib.GetType(), indices);
+}
+
+void Renderer::DrawInstanced(const VertexArray & va, const IndexBuffer & ib, unsigned int instanceCount, unsigned int mode, int baseVertex)
+{
+	if (instanceCount == 0)
+		return;
+	va.Bind();
+	ib.Bind();
+	ib.BindPrimitiveRestart();
+	const void* indices = (const void*)(size_t)ib.GetOffset();
+	if (baseVertex != 0)
+		glDrawElementsInstancedBaseVertex(mode, ib.GetCount(), ib.GetType(), indices, instanceCount, baseVertex);
+	else
+		glDrawElementsInstanced(mode, ib.GetCount(), ib.GetType(), indices, instanceCount);
+}
@@ -0,0 +1,203 @@
+
+// RingBuffer.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "GLState.h"
+
+//Allocate()가 돌려주는 범위. Data에 바로 쓰면 됨(Offset은 버퍼 시작부터의 byte 위치)
+struct RingAllocation
+{
+	unsigned int Offset;
+	unsigned int Size;
+	void* Data;
+};
+
+//GPU가 CPU를 따라오지 못해서 BeginFrame에서 기다린 횟수/시간
+struct RingBufferStats
+{
+	unsigned int Stalls = 0;
+	double StallMs = 0.0;
+	unsigned int Overflows = 0; //frame 영역이 부족해서 Allocate가 실패한 횟수
+};
+
+//큰 버퍼 하나를 frame 수만큼 영역으로 나눠 돌려가며 쓰는 업로드용 버퍼.
+//ARB_buffer_storage(GL 4.4)가 있으면 생성 시 한번만 persistent + coherent map하고, 이후에는 포인터에 쓰기만 함(업로드마다 GL 호출 없음).
+//각 frame 영역은 EndFrame의 fence로 보호되므로, 다시 그 영역을 쓸 차례가 되었을 때 GPU가 아직 읽는 중이면 BeginFrame에서 기다리고 그 시간을 기록함.
+//확장이 없으면 CPU 버퍼에 모아두었다가 Flush()에서 한번에 glBufferSubData로 올림
+//
+//vertex/index/uniform 데이터를 모두 담을 수 있음. VertexBuffer/IndexBuffer의 RingBuffer 생성자로 감싸서 VertexArray에 연결하거나,
+//BindRange(GL_UNIFORM_BUFFER, ...)로 uniform block에 연결
+class RingBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_FrameSize; //frame 영역 하나의 크기(byte)
+	unsigned int m_FrameCount;
+	unsigned int m_Frame; //현재 쓰는 frame 영역
+	unsigned int m_Head; //현재 frame 영역 안에서 사용한 크기
+	bool m_Persistent;
+	unsigned char* m_Mapped; //persistent map된 포인터(버퍼 전체), 또는 CPU staging 버퍼
+	std::vector<unsigned char> m_Staging;
+	std::vector<GLsync> m_Fences; //frame 영역마다 마지막으로 그 영역을 읽는 명령 뒤에 넣은 fence
+	RingBufferStats m_Stats;
+public:
+	RingBuffer(unsigned int frameSize, unsigned int frameCount = 3);
+	~RingBuffer();
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	bool IsFrameAvailable() const; //다음 BeginFrame이 기다리지 않고 바로 반환되는지(블로킹 없음)
+	void BeginFrame(); //다음 frame 영역으로 이동. GPU가 아직 그 영역을 읽고 있으면 기다리고 Stall로 기록
+	RingAllocation Allocate(unsigned int size, unsigned int alignment = 16); //공간이 부족하면 Data가 nullptr
+	void Flush(); //draw 전에 호출. persistent map이면 아무것도 하지 않음
+	void EndFrame(); //이번 frame의 draw를 모두 제출한 뒤 호출(fence 삽입)
+
+	void Bind(unsigned int target) const;
+	void BindRange(unsigned int target, unsigned int bindingPoint, const RingAllocation& allocation) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_FrameSize * m_FrameCount; }
+	inline unsigned int GetUsedSize() const { return m_Head; }
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline const RingBufferStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = {}; }
+};
+
+// RingBuffer.cpp
+
+RingBuffer::RingBuffer(unsigned int frameSize, unsigned int frameCount)
+	: m_RendererID{ 0 }, m_FrameSize{ (frameSize + 255) & ~255u }, m_FrameCount{ frameCount }, m_Frame{ 0 }, m_Head{ 0 },
+	m_Persistent{ false }, m_Mapped{ nullptr }, m_Fences(frameCount, nullptr)
+{
+	//frame 영역의 시작이 uniform buffer offset alignment(보통 256 이하)에도 맞도록 256 단위로 올림
+	GLsizeiptr size = (GLsizeiptr)m_FrameSize * m_FrameCount;
+
+	glGenBuffers(1, &m_RendererID);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID); //어떤 용도로 쓸지 모르므로 중립적인 target 사용
+
+	if (GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags); //크기가 고정된 저장소(immutable)
+		m_Mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags); //unmap하지 않고 계속 사용
+		m_Persistent = m_Mapped != nullptr;
+	}
+
+	if (!m_Persistent)
+	{
+		if (GLEW_ARB_buffer_storage) //map에 실패한 경우
+			std::cout << "Warning: RingBuffer persistent map 실패, glBufferSubData 사용\n";
+		else
+			glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		m_Staging.resize(size);
+		m_Mapped = m_Staging.data();
+	}
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+RingBuffer::~RingBuffer()
+{
+	for (GLsync fence : m_Fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+	}
+	if (m_Persistent)
+	{
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+	GLState::OnDeleteBuffer(m_RendererID);
+	glDeleteBuffers(1, &m_RendererID);
+}
+
+bool RingBuffer::IsFrameAvailable() const
+{
+	GLsync fence = m_Fences[(m_Frame + 1) % m_FrameCount];
+	if (!fence)
+		return true;
+	GLenum result = glClientWaitSync(fence, 0, 0); //timeout 0: 상태만 확인
+	return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void RingBuffer::BeginFrame()
+{
+	m_Frame = (m_Frame + 1) % m_FrameCount;
+	m_Head = 0;
+
+	GLsync& fence = m_Fences[m_Frame];
+	if (!fence)
+		return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+	{
+		//GPU가 frameCount frame 이상 뒤처짐. 영역을 덮어쓰면 안되므로 기다리되 그 시간을 기록
+		auto start = std::chrono::steady_clock::now();
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT; //fence가 아직 GPU에 제출되지 않았을 수 있으므로 처음 한번은 flush
+		do
+		{
+			result = glClientWaitSync(fence, flags, 1000000); //1ms 단위로 확인
+			flags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+		m_Stats.Stalls++;
+		m_Stats.StallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+RingAllocation RingBuffer::Allocate(unsigned int size, unsigned int alignment)
+{
+	unsigned int offset = alignment > 1 ? (m_Head + alignment - 1) / alignment * alignment : m_Head;
+	if (offset + size > m_FrameSize)
+	{
+		m_Stats.Overflows++;
+		std::cout << "Warning: ring buffer frame 영역 부족(" << m_FrameSize << " bytes)\n";
+		return { 0, 0, nullptr };
+	}
+
+	m_Head = offset + size;
+	unsigned int bufferOffset = m_Frame * m_FrameSize + offset;
+	return { bufferOffset, size, m_Mapped + bufferOffset };
+}
+
+void RingBuffer::Flush()
+{
+	if (m_Persistent || m_Head == 0)
+		return;
+
+	//coherent map이 없으면 이번 frame에 쓴 범위를 한번에 업로드
+	unsigned int start = m_Frame * m_FrameSize;
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, start, m_Head, m_Staging.data() + start);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void RingBuffer::EndFrame()
+{
+	//이 fence가 signal되면 지금까지 제출된 draw(이번 frame 영역을 읽는 명령)가 모두 끝난 것
+	GLsync& fence = m_Fences[m_Frame];
+	if (fence)
+		glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void RingBuffer::Bind(unsigned int target) const
+{
+	GLState::BindBuffer(target, m_RendererID);
+}
+
+void RingBuffer::BindRange(unsigned int target, unsigned int bindingPoint, const RingAllocation& allocation) const
+{
+	GLState::BindBufferRange(target, bindingPoint, m_RendererID, allocation.Offset, allocation.Size);
+}
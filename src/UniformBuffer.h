@@ -0,0 +1,127 @@
+
+// UniformBuffer.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+#include "GLState.h"
+#include "RingBuffer.h"
+
+//std140 규칙의 정렬/크기 계산. C++ 구조체의 멤버 offset이 GLSL uniform block과 같은지 컴파일 타임에 확인하는데 사용
+//
+//	struct PerDraw { std140::vec4 Color; std140::mat4 Model; float Time; };
+//	using PerDrawLayout = std140::Layout<std140::vec4, std140::mat4, float>;
+//	STD140_CHECK(PerDraw, Model, PerDrawLayout, 1);
+//	STD140_CHECK(PerDraw, Time, PerDrawLayout, 2);
+namespace std140
+{
+	struct vec2 { float x, y; };
+	struct vec3 { float x, y, z; };
+	struct vec4 { float x, y, z, w; };
+	struct mat4 { vec4 Columns[4]; };
+
+	template<typename T>
+	struct Traits;
+
+	template<> struct Traits<float> { static constexpr size_t Align = 4, Size = 4; };
+	template<> struct Traits<int> { static constexpr size_t Align = 4, Size = 4; };
+	template<> struct Traits<unsigned int> { static constexpr size_t Align = 4, Size = 4; };
+	template<> struct Traits<vec2> { static constexpr size_t Align = 8, Size = 8; };
+	template<> struct Traits<vec3> { static constexpr size_t Align = 16, Size = 12; }; //vec3 뒤에 float 하나가 붙을 수 있음
+	template<> struct Traits<vec4> { static constexpr size_t Align = 16, Size = 16; };
+	template<> struct Traits<mat4> { static constexpr size_t Align = 16, Size = 64; };
+
+	//배열은 원소 하나하나가 vec4(16 byte) 단위로 정렬됨
+	template<typename T, size_t N>
+	struct Traits<T[N]>
+	{
+		static constexpr size_t Stride = (Traits<T>::Size + 15) & ~size_t(15);
+		static constexpr size_t Align = 16, Size = Stride * N;
+	};
+
+	template<typename... Ts>
+	struct Layout
+	{
+		static_assert(sizeof...(Ts) > 0, "empty uniform block");
+
+		static constexpr size_t Offset(size_t index)
+		{
+			constexpr size_t aligns[] = { Traits<Ts>::Align... };
+			constexpr size_t sizes[] = { Traits<Ts>::Size... };
+			size_t offset = 0;
+			for (size_t i = 0; i < sizeof...(Ts); i++)
+			{
+				offset = (offset + aligns[i] - 1) & ~(aligns[i] - 1);
+				if (i == index)
+					return offset;
+				offset += sizes[i];
+			}
+			return (offset + 15) & ~size_t(15); //index == 멤버 수이면 block 전체 크기(16 byte 단위로 올림)
+		}
+
+		static constexpr size_t Size() { return Offset(sizeof...(Ts)); }
+	};
+}
+
+#define STD140_CHECK(Struct, Member, LayoutType, Index) \
+	static_assert(offsetof(Struct, Member) == LayoutType::Offset(Index), #Struct "::" #Member " doesn't match std140 offset")
+
+
+//Allocate()가 돌려주는 per-draw block. Data에 값을 쓰고, Upload() 후 BindRange()로 바인딩
+using UniformAllocation = RingAllocation;
+
+//uniform block용 RingBuffer. offset을 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT에 맞춰 할당하고 GL_UNIFORM_BUFFER binding point에 연결하는 것만 더함.
+//draw마다 glUniform*를 여러번 부르는 대신 frame당 업로드 한번(persistent map이면 0번) + draw마다 GLState::BindBufferRange(offset 교체)만 함
+//frame 영역 보호(fence)와 업로드 방식은 RingBuffer와 같으므로, frame 끝에 EndFrame()을 불러야 GPU가 읽는 중인 영역을 덮어쓰지 않음
+class UniformRingBuffer
+{
+private:
+	unsigned int m_Alignment; //GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, m_Ring보다 먼저 초기화되어야 함
+	RingBuffer m_Ring;
+public:
+	UniformRingBuffer(unsigned int frameSize, unsigned int frameCount = 3);
+
+	void BeginFrame() { m_Ring.BeginFrame(); } //다음 frame 영역으로 이동. GPU가 아직 그 영역을 읽고 있으면 기다림
+	UniformAllocation Allocate(unsigned int size) { return m_Ring.Allocate(size, m_Alignment); } //공간이 부족하면 Data가 nullptr
+	template<typename T>
+	UniformAllocation Push(const T& block)
+	{
+		UniformAllocation allocation = Allocate(sizeof(T));
+		if (allocation.Data)
+			std::memcpy(allocation.Data, &block, sizeof(T));
+		return allocation;
+	}
+	void Upload() { m_Ring.Flush(); } //draw 전에 호출. persistent map이면 아무것도 하지 않음
+	void EndFrame() { m_Ring.EndFrame(); } //이번 frame의 draw를 모두 제출한 뒤 호출
+
+	void BindRange(unsigned int bindingPoint, const UniformAllocation& allocation) const { m_Ring.BindRange(GL_UNIFORM_BUFFER, bindingPoint, allocation); }
+
+	inline unsigned int GetRendererID() const { return m_Ring.GetRendererID(); }
+	inline unsigned int GetAlignment() const { return m_Alignment; }
+	inline unsigned int GetUsedSize() const { return m_Ring.GetUsedSize(); }
+	inline const RingBufferStats& GetStats() const { return m_Ring.GetStats(); }
+private:
+	static unsigned int QueryAlignment();
+};
+
+// UniformBuffer.cpp
+
+UniformRingBuffer::UniformRingBuffer(unsigned int frameSize, unsigned int frameCount)
+	: m_Alignment{ QueryAlignment() },
+	//alignment는 2의 거듭제곱이고 RingBuffer는 frame 크기를 256 단위로 올리므로, alignment 단위로 올려두면 각 frame 영역의 시작도 alignment에 맞음
+	m_Ring{ (frameSize + m_Alignment - 1) / m_Alignment * m_Alignment, frameCount }
+{
+}
+
+unsigned int UniformRingBuffer::QueryAlignment()
+{
+	int alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment > 0 ? alignment : 256;
+}
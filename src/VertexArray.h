@@ -0,0 +1,317 @@
+
+// VertexArray.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+//VAO. 여러 VertexBuffer(stream)를 각자의 layout/stride로 붙일 수 있음(SoA)
+//예) depth/shadow pass는 position stream만 붙인 VAO를, 일반 pass는 position + 나머지 attribute stream을 붙인 VAO를 사용.
+//    같은 VertexBuffer를 여러 VAO에 붙일 수 있으므로 데이터는 한 번만 업로드하고, depth pass는 position만 읽게 됨
+//
+//형식과 버퍼를 분리하는 방법: SetFormat()으로 binding 번호마다 layout만 정해두고, draw 전에 BindVertexBuffer()로 버퍼만 교체.
+//같은 layout의 mesh들이 VAO 하나를 공유할 수 있음(VertexArrayCache). AddBuffer와 한 VAO에서 섞어 쓰지 않음
+//  - GL 4.5 / ARB_direct_state_access: glVertexArrayAttribFormat, glVertexArrayVertexBuffer (VAO를 bind하지 않아도 됨)
+//  - GL 4.3 / ARB_vertex_attrib_binding: glVertexAttribFormat, glBindVertexBuffer
+//  - GL 3.3: 버퍼를 바꿀 때 그 binding의 attribute마다 glVertexAttribPointer를 다시 호출
+//DSA가 아닌 경로에서는 BindVertexBuffer/BindIndexBuffer 전에 이 VAO가 bind되어 있어야 함
+//
+//instancing: divisor가 0이 아닌 stream은 vertex가 아니라 instance마다 다음 원소를 읽음. mesh stream과 instance stream을 한 VAO에 붙이고
+//Renderer::DrawInstanced로 한 번에 그림. 4개를 넘는 성분(mat4)은 연속된 location 여러 개로 나뉨
+//  va.AddBuffer<QuadVertex>(quadVB);          //location 0
+//  va.AddInstanceBuffer<Instance>(instanceVB); //location 1~4(mat4), 5(color)
+enum class VertexFormatPath
+{
+	AttribPointer, AttribBinding, DirectStateAccess
+};
+
+class VertexArray
+{
+private:
+	struct Binding
+	{
+		std::vector<VertexAttribute> Attributes;
+		unsigned int Stride = 0;
+		unsigned int FirstAttribute = 0;
+		unsigned int Divisor = 0;
+		unsigned int BufferID = 0; //현재 붙어 있는 버퍼와 offset(같으면 다시 bind하지 않음)
+		unsigned int Offset = 0;
+	};
+
+	unsigned int m_RendererID;
+	unsigned int m_NextAttribute; //다음 AddBuffer가 firstAttribute를 생략했을 때 사용할 location
+	std::vector<Binding> m_Bindings; //SetFormat으로 정한 binding별 형식. Attributes는 location 하나에 하나(mat4는 열 4개로 나뉘어 있음)
+	unsigned int m_IndexBufferID;
+	unsigned int m_BufferGeneration; //위의 BufferID/m_IndexBufferID를 기억한 시점의 GLState::GetBufferGeneration()
+public:
+	static constexpr unsigned int NextAttribute = 0xFFFFFFFF;
+
+	VertexArray();
+	~VertexArray();
+
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+
+	//layout의 element들을 firstAttribute부터 차례로 location에 연결. 생략하면 이전 AddBuffer가 사용한 다음 location부터
+	//divisor는 layout.GetDivisor()
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute = NextAttribute);
+	//DEFINE_VERTEX_LAYOUT으로 정의한 컴파일 타임 layout 사용(vector 없이 attribute 배열을 그대로 읽음)
+	template<typename Vertex>
+	void AddBuffer(const VertexBuffer& vb, unsigned int firstAttribute = NextAttribute)
+	{
+		constexpr const auto& layout = VertexLayoutOf<Vertex>::Value;
+		AddAttributes(vb, layout.Attributes, layout.Count, layout.Stride, firstAttribute, 0);
+	}
+	//instance마다 읽는 stream(divisor개의 instance가 원소 하나를 공유)
+	template<typename Instance>
+	void AddInstanceBuffer(const VertexBuffer& vb, unsigned int firstAttribute = NextAttribute, unsigned int divisor = 1)
+	{
+		constexpr const auto& layout = VertexLayoutOf<Instance>::Value;
+		AddAttributes(vb, layout.Attributes, layout.Count, layout.Stride, firstAttribute, divisor);
+	}
+
+	//binding 번호의 형식만 정함. attribute location은 firstAttribute부터(생략하면 이어서). divisor는 layout.GetDivisor()
+	void SetFormat(const VertexBufferLayout& layout, unsigned int binding, unsigned int firstAttribute = NextAttribute);
+	//binding에 버퍼를 붙임(stride는 SetFormat의 layout). 이미 같은 버퍼/offset이면 아무것도 하지 않고 false 반환
+	bool BindVertexBuffer(unsigned int binding, const VertexBuffer& vb, unsigned int offset = 0);
+	bool BindIndexBuffer(const IndexBuffer& ib);
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetAttributeCount() const { return m_NextAttribute; } //사용한 location 수(가장 큰 location + 1)
+	inline unsigned int GetBindingCount() const { return (unsigned int)m_Bindings.size(); }
+
+	static VertexFormatPath GetFormatPath();
+private:
+	void AddAttributes(const VertexBuffer& vb, const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int firstAttribute, unsigned int divisor);
+	//attribute 하나를 location에 연결(vb가 bind된 상태). 사용한 location 수 반환
+	static unsigned int EnableAttribute(unsigned int location, const VertexAttribute& attribute, unsigned int stride, unsigned int divisor);
+	//location 하나에 하나씩 되도록 나눔(4개를 넘는 성분은 vec4 열 단위로)
+	static void SplitAttribute(const VertexAttribute& attribute, std::vector<VertexAttribute>& out);
+	//그 사이 삭제된 버퍼가 있으면 기억한 버퍼 이름을 버림(삭제된 이름을 GL이 새 버퍼에 다시 쓰면 bind가 생략되어 버림)
+	void ValidateBufferCache();
+};
+
+// VertexArray.cpp
+
+VertexArray::VertexArray()
+	: m_NextAttribute{ 0 }, m_IndexBufferID{ 0 }, m_BufferGeneration{ GLState::GetBufferGeneration() }
+{
+	if (GetFormatPath() == VertexFormatPath::DirectStateAccess)
+		glCreateVertexArrays(1, &m_RendererID); //DSA 함수는 한 번도 bind되지 않은(glGen만 한) 이름에는 쓸 수 없음
+	else
+		glGenVertexArrays(1, &m_RendererID); //vao 생성
+	//glBindVertexArray(m_RendererID); //vao 바인딩(="작업 상태") <-- 바인딩은 AddBuffer 직전에 수행하도록 함
+}
+
+VertexArray::~VertexArray()
+{
+	GLState::OnDeleteVertexArray(m_RendererID);
+	glDeleteVertexArrays(1, &m_RendererID);
+}
+
+void VertexArray::AddBuffer(const VertexBuffer & vb, const VertexBufferLayout & layout, unsigned int firstAttribute)
+{
+	Bind(); //vao를 바인딩
+
+	vb.Bind(); //Vertex Buffer를 바인딩. glVertexAttribPointer 시점에 바인딩된 버퍼가 각 attribute에 기록되므로 stream마다 다른 버퍼를 쓸 수 있음
+
+	if (firstAttribute == NextAttribute)
+		firstAttribute = m_NextAttribute;
+
+	const auto& elements = layout.GetElement();
+	unsigned int offset = 0;
+	unsigned int location = firstAttribute;
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		//layout별로 데이터를 어떻게 읽어와야하는지를 element구조체로 가지고 있음. 이를 활용함.
+		location += EnableAttribute(location, { element.type, element.count, element.normalized, offset, element.GetSize() }, layout.GetStride(), layout.GetDivisor());
+		offset += element.GetSize();
+	}
+	m_NextAttribute = std::max(m_NextAttribute, location);
+}
+
+void VertexArray::AddAttributes(const VertexBuffer & vb, const VertexAttribute * attributes, unsigned int count, unsigned int stride, unsigned int firstAttribute, unsigned int divisor)
+{
+	Bind();
+	vb.Bind();
+
+	if (firstAttribute == NextAttribute)
+		firstAttribute = m_NextAttribute;
+
+	unsigned int location = firstAttribute;
+	for (unsigned int i = 0; i < count; i++)
+		location += EnableAttribute(location, attributes[i], stride, divisor); //offset은 컴파일 타임에 offsetof로 계산됨
+	m_NextAttribute = std::max(m_NextAttribute, location);
+}
+
+unsigned int VertexArray::EnableAttribute(unsigned int location, const VertexAttribute & attribute, unsigned int stride, unsigned int divisor)
+{
+	unsigned int locations = attribute.GetLocationCount();
+	unsigned int components = locations > 1 ? 4 : attribute.count;
+	unsigned int columnSize = attribute.size / locations;
+	for (unsigned int column = 0; column < locations; column++)
+	{
+		glEnableVertexAttribArray(location + column); //기존에는 0번만 존재했으나, position/normal/color등 여러 attribute가 생기면, 여러 attribute를 enable해야함
+		glVertexAttribPointer(location + column, components, attribute.type, attribute.normalized, stride, (const void*)(size_t)(attribute.offset + column * columnSize));
+		glVertexAttribDivisor(location + column, divisor); //VAO에 기록되므로 같은 location을 다시 쓰는 경우를 위해 0도 설정
+	}
+	return locations;
+}
+
+void VertexArray::SplitAttribute(const VertexAttribute & attribute, std::vector<VertexAttribute>& out)
+{
+	unsigned int locations = attribute.GetLocationCount();
+	if (locations == 1)
+	{
+		out.push_back(attribute);
+		return;
+	}
+	unsigned int columnSize = attribute.size / locations;
+	for (unsigned int column = 0; column < locations; column++)
+		out.push_back({ attribute.type, 4, attribute.normalized, attribute.offset + column * columnSize, columnSize });
+}
+
+VertexFormatPath VertexArray::GetFormatPath()
+{
+	if (GLEW_ARB_direct_state_access)
+		return VertexFormatPath::DirectStateAccess;
+	if (GLEW_ARB_vertex_attrib_binding)
+		return VertexFormatPath::AttribBinding;
+	return VertexFormatPath::AttribPointer;
+}
+
+void VertexArray::SetFormat(const VertexBufferLayout & layout, unsigned int binding, unsigned int firstAttribute)
+{
+	if (firstAttribute == NextAttribute)
+		firstAttribute = m_NextAttribute;
+	if (m_Bindings.size() <= binding)
+		m_Bindings.resize(binding + 1);
+
+	Binding& target = m_Bindings[binding];
+	target = Binding{};
+	target.Stride = layout.GetStride();
+	target.FirstAttribute = firstAttribute;
+	target.Divisor = layout.GetDivisor();
+	unsigned int offset = 0;
+	for (const VertexBufferElement& element : layout.GetElement())
+	{
+		SplitAttribute({ element.type, element.count, element.normalized, offset, element.GetSize() }, target.Attributes);
+		offset += element.GetSize();
+	}
+	m_NextAttribute = std::max(m_NextAttribute, firstAttribute + (unsigned int)target.Attributes.size());
+
+	VertexFormatPath path = GetFormatPath();
+	if (path != VertexFormatPath::DirectStateAccess)
+		Bind();
+	for (unsigned int i = 0; i < target.Attributes.size(); i++)
+	{
+		const VertexAttribute& attribute = target.Attributes[i];
+		unsigned int location = firstAttribute + i;
+		switch (path)
+		{
+			case VertexFormatPath::DirectStateAccess:
+				glEnableVertexArrayAttrib(m_RendererID, location);
+				glVertexArrayAttribFormat(m_RendererID, location, attribute.count, attribute.type, attribute.normalized, attribute.offset);
+				glVertexArrayAttribBinding(m_RendererID, location, binding);
+				break;
+			case VertexFormatPath::AttribBinding:
+				glEnableVertexAttribArray(location);
+				glVertexAttribFormat(location, attribute.count, attribute.type, attribute.normalized, attribute.offset);
+				glVertexAttribBinding(location, binding);
+				break;
+			case VertexFormatPath::AttribPointer:
+				glEnableVertexAttribArray(location); //형식은 버퍼가 붙을 때 glVertexAttribPointer로 지정
+				glVertexAttribDivisor(location, target.Divisor);
+				break;
+		}
+	}
+	//vertex attrib binding 경로에서는 divisor가 location이 아니라 binding에 붙음
+	if (path == VertexFormatPath::DirectStateAccess)
+		glVertexArrayBindingDivisor(m_RendererID, binding, target.Divisor);
+	else if (path == VertexFormatPath::AttribBinding)
+		glVertexBindingDivisor(binding, target.Divisor);
+}
+
+bool VertexArray::BindVertexBuffer(unsigned int binding, const VertexBuffer & vb, unsigned int offset)
+{
+	assert(binding < m_Bindings.size() && "call SetFormat for this binding first");
+	ValidateBufferCache();
+	Binding& target = m_Bindings[binding];
+	if (target.BufferID == vb.GetRendererID() && target.Offset == offset)
+		return false;
+	target.BufferID = vb.GetRendererID();
+	target.Offset = offset;
+
+	switch (GetFormatPath())
+	{
+		case VertexFormatPath::DirectStateAccess:
+			glVertexArrayVertexBuffer(m_RendererID, binding, target.BufferID, offset, target.Stride);
+			break;
+		case VertexFormatPath::AttribBinding:
+			glBindVertexBuffer(binding, target.BufferID, offset, target.Stride);
+			break;
+		case VertexFormatPath::AttribPointer:
+			vb.Bind();
+			for (unsigned int i = 0; i < target.Attributes.size(); i++)
+			{
+				const VertexAttribute& attribute = target.Attributes[i];
+				glVertexAttribPointer(target.FirstAttribute + i, attribute.count, attribute.type, attribute.normalized, target.Stride,
+					(const void*)(size_t)(offset + attribute.offset));
+			}
+			break;
+	}
+	return true;
+}
+
+bool VertexArray::BindIndexBuffer(const IndexBuffer & ib)
+{
+	ValidateBufferCache();
+	if (m_IndexBufferID == ib.GetRendererID())
+		return false;
+	m_IndexBufferID = ib.GetRendererID();
+	if (GetFormatPath() == VertexFormatPath::DirectStateAccess)
+	{
+		glVertexArrayElementBuffer(m_RendererID, m_IndexBufferID);
+		if (GLState::GetVertexArray() == m_RendererID)
+			GLState::InvalidateBuffer(GL_ELEMENT_ARRAY_BUFFER);
+	}
+	else
+		ib.Bind(); //VAO가 bind된 상태에서 GL_ELEMENT_ARRAY_BUFFER binding은 VAO에 기록됨
+	return true;
+}
+
+void VertexArray::ValidateBufferCache()
+{
+	if (m_BufferGeneration == GLState::GetBufferGeneration())
+		return;
+	m_BufferGeneration = GLState::GetBufferGeneration();
+	//0은 어떤 버퍼와도 같지 않으므로 다음 Bind*Buffer는 항상 GL로 전달됨
+	for (Binding& binding : m_Bindings)
+	{
+		binding.BufferID = 0;
+		binding.Offset = 0;
+	}
+	m_IndexBufferID = 0;
+}
+
+void VertexArray::Bind() const
+{
+	GLState::BindVertexArray(m_RendererID);
+}
+
+void VertexArray::Unbind() const
+{
+	GLState::BindVertexArray(0);
+}
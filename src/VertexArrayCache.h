@@ -0,0 +1,133 @@
+
+// VertexArrayCache.h
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <initializer_list>
+
+#include "VertexArray.h"
+
+//frame 하나 동안의 VAO/버퍼 bind 수. BeginFrame()에서 초기화
+struct VertexArrayCacheStats
+{
+	unsigned int VertexArrayCount = 0; //cache가 가진 VAO 수(layout 조합 수)
+	unsigned int VertexArrayBinds = 0; //glBindVertexArray 호출 수
+	unsigned int VertexBufferBinds = 0; //vertex 버퍼 교체 수(glBindVertexBuffer 등)
+	unsigned int IndexBufferBinds = 0;
+	unsigned int SkippedBinds = 0; //이미 bind되어 있어서 생략한 수
+};
+
+//layout(stream들의 VertexBufferLayout) 해시별로 VAO를 하나만 만들어 공유.
+//mesh를 바꿀 때는 VAO가 같으면 버퍼만 바꾸고(VertexArray::BindVertexBuffer), 버퍼까지 같으면(GpuHeap의 같은 page 등) 아무것도 호출하지 않음
+//  VertexArray& va = cache.Get(layout);            //로딩 시 mesh마다
+//  cache.Bind(va, { &mesh.vb }, &mesh.ib);          //draw 직전
+//현재 bind된 VAO는 GLState가 기억하므로 cache를 통하지 않고 bind해도 됨
+class VertexArrayCache
+{
+private:
+	struct Entry
+	{
+		std::vector<VertexBufferLayout> Streams;
+		std::unique_ptr<VertexArray> Array;
+	};
+
+	std::unordered_map<uint64_t, std::vector<Entry>> m_Entries; //해시가 같아도 layout이 다르면 같은 bucket에 따로 저장
+	VertexArrayCacheStats m_Stats;
+public:
+	//stream i는 binding i, attribute location은 stream 순서대로 0부터 이어서 배정
+	VertexArray& Get(std::initializer_list<const VertexBufferLayout*> streams);
+	VertexArray& Get(const VertexBufferLayout& layout) { return Get({ &layout }); }
+
+	//VAO가 바뀌었을 때만 bind하고, buffers[i]를 binding i에 붙임(바뀐 것만)
+	void Bind(VertexArray& va, std::initializer_list<const VertexBuffer*> buffers, const IndexBuffer* ib = nullptr);
+
+	void BeginFrame(); //frame 통계 초기화
+	void Clear();
+
+	inline const VertexArrayCacheStats& GetFrameStats() const { return m_Stats; }
+	void PrintFrameStats() const;
+};
+
+// VertexArrayCache.cpp
+
+VertexArray& VertexArrayCache::Get(std::initializer_list<const VertexBufferLayout*> streams)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const VertexBufferLayout* layout : streams)
+		hash = (hash ^ layout->GetHash()) * 1099511628211ull;
+
+	std::vector<Entry>& bucket = m_Entries[hash];
+	for (Entry& entry : bucket)
+	{
+		if (entry.Streams.size() != streams.size())
+			continue;
+		bool same = true;
+		unsigned int i = 0;
+		for (const VertexBufferLayout* layout : streams)
+			same = same && entry.Streams[i++] == *layout;
+		if (same)
+			return *entry.Array;
+	}
+
+	Entry entry;
+	entry.Array = std::make_unique<VertexArray>();
+	unsigned int binding = 0;
+	for (const VertexBufferLayout* layout : streams)
+	{
+		entry.Streams.push_back(*layout);
+		entry.Array->SetFormat(*layout, binding++);
+	}
+	bucket.push_back(std::move(entry));
+	m_Stats.VertexArrayCount++;
+	return *bucket.back().Array;
+}
+
+void VertexArrayCache::Bind(VertexArray& va, std::initializer_list<const VertexBuffer*> buffers, const IndexBuffer* ib)
+{
+	if (GLState::GetVertexArray() != va.GetRendererID())
+	{
+		va.Bind();
+		m_Stats.VertexArrayBinds++;
+	}
+	else
+		m_Stats.SkippedBinds++;
+
+	unsigned int binding = 0;
+	for (const VertexBuffer* vb : buffers)
+	{
+		if (va.BindVertexBuffer(binding++, *vb))
+			m_Stats.VertexBufferBinds++;
+		else
+			m_Stats.SkippedBinds++;
+	}
+	if (ib)
+	{
+		if (va.BindIndexBuffer(*ib))
+			m_Stats.IndexBufferBinds++;
+		else
+			m_Stats.SkippedBinds++;
+	}
+}
+
+void VertexArrayCache::BeginFrame()
+{
+	unsigned int count = m_Stats.VertexArrayCount;
+	m_Stats = VertexArrayCacheStats{};
+	m_Stats.VertexArrayCount = count;
+}
+
+void VertexArrayCache::Clear()
+{
+	m_Entries.clear();
+	m_Stats = VertexArrayCacheStats{};
+}
+
+void VertexArrayCache::PrintFrameStats() const
+{
+	std::cout << "VAO " << m_Stats.VertexArrayCount << ", binds: VAO " << m_Stats.VertexArrayBinds << ", vertex buffer " << m_Stats.VertexBufferBinds
+		<< ", index buffer " << m_Stats.IndexBufferBinds << ", skipped " << m_Stats.SkippedBinds << std::endl;
+}
@@ -0,0 +1,199 @@
+
+// VertexBuffer.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <iostream>
+#include <assert.h>
+#include <cstring>
+
+#include "GLState.h"
+#include "RingBuffer.h"
+#include "GpuHeap.h"
+
+//버퍼 데이터를 얼마나 자주 바꾸는지에 대한 힌트. 드라이버가 버퍼를 어느 메모리에 둘지 결정하는데 사용
+enum class BufferUsage
+{
+	Static, //한번 올리고 계속 그림(모델)
+	Dynamic, //가끔 일부를 바꿈
+	Stream //매 frame 새로 채움(UI, 디버그 라인, 파티클)
+};
+
+class VertexBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size; //byte 사이즈
+	BufferUsage m_Usage;
+	unsigned int m_StreamHead; //Stream()으로 이번 버퍼 저장소에 쓴 위치
+	bool m_Owned; //RingBuffer를 감싼 경우 버퍼를 삭제/재할당하지 않음
+	GpuHeap* m_Heap; //GpuHeap 안에 있으면 그 heap과 범위
+	GpuHeapAllocation m_Allocation;
+public:
+	VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static); //size는 byte 사이즈, 데이터의 타입은 모르기 때문에 void*로. data가 nullptr이면 공간만 할당
+	//RingBuffer를 vertex buffer로 사용(소유하지 않음). 데이터는 ring.Allocate()로 쓰고, draw의 first(또는 base vertex)를 Offset / stride로 지정
+	explicit VertexBuffer(const RingBuffer& ring);
+	//heap의 page 버퍼 안에 범위를 할당해서 사용. 같은 page의 mesh끼리 VAO를 공유하고, draw할 때 GetBaseVertex(stride)를 base vertex로 지정
+	//offset이 항상 stride의 배수여야 하므로 heap의 granularity가 stride의 배수가 아니면 할당하지 않음(GetRendererID() == 0)
+	VertexBuffer(GpuHeap& heap, const void* data, unsigned int size, unsigned int stride);
+	~VertexBuffer();
+
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
+	//일부 범위만 glBufferSubData로 덮어씀. GPU가 아직 이전 내용으로 그리는 중이면 드라이버가 복사본을 만들거나 기다릴 수 있음
+	void Update(unsigned int offset, const void* data, unsigned int size);
+	//버퍼 전체를 새 저장소로 교체(glBufferData(nullptr))한 뒤 data를 씀. 이전 저장소는 GPU가 다 쓰면 드라이버가 해제하므로 기다리지 않음
+	void Orphan(const void* data, unsigned int size);
+	//버퍼 뒤쪽 빈 공간에 동기화 없이 map해서 쓰고 그 offset을 반환. 공간이 부족하면 orphan 후 처음부터 다시 씀
+	//이미 쓴 범위는 덮어쓰지 않으므로 GPU가 읽는 중인 데이터와 겹치지 않음. 반환된 offset을 draw의 first/attribute offset으로 사용
+	unsigned int Stream(const void* data, unsigned int size);
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+	inline unsigned int GetOffset() const { return m_Allocation.Offset; } //버퍼 안에서 데이터가 시작하는 byte 위치(자기 버퍼면 0)
+	inline int GetBaseVertex(unsigned int stride) const { assert(m_Allocation.Offset % stride == 0); return (int)(m_Allocation.Offset / stride); }
+
+	static unsigned int GetGLUsage(BufferUsage usage);
+};
+
+// VertexBuffer.cpp
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage)
+	: m_RendererID{ 0 }, m_Size{ size }, m_Usage{ usage }, m_StreamHead{ 0 }, m_Owned{ true }, m_Heap{ nullptr }
+{
+	glGenBuffers(1, &m_RendererID); //1. 버퍼 생성
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID); //2. 바인딩("작업 상태")
+	glBufferData(GL_ARRAY_BUFFER, size, data, GetGLUsage(usage));  //3. 작업 상태 버퍼에 데이터 전달
+	if (data)
+		m_StreamHead = size;
+}
+
+VertexBuffer::VertexBuffer(const RingBuffer& ring)
+	: m_RendererID{ ring.GetRendererID() }, m_Size{ ring.GetSize() }, m_Usage{ BufferUsage::Stream }, m_StreamHead{ 0 }, m_Owned{ false }, m_Heap{ nullptr }
+{
+}
+
+VertexBuffer::VertexBuffer(GpuHeap& heap, const void* data, unsigned int size, unsigned int stride)
+	: m_RendererID{ 0 }, m_Size{ size }, m_Usage{ BufferUsage::Static }, m_StreamHead{ 0 }, m_Owned{ false }, m_Heap{ &heap }
+{
+	//모든 offset은 granularity의 배수이므로, granularity가 stride의 배수여야 base vertex = Offset / stride가 정확함
+	if (stride == 0 || heap.GetGranularity() % stride != 0)
+	{
+		std::cout << "Warning: GpuHeap granularity(" << heap.GetGranularity() << ") isn't a multiple of vertex stride(" << stride << ")\n";
+		assert(0);
+		m_Size = 0;
+		return;
+	}
+
+	m_Allocation = heap.Allocate(size);
+	m_RendererID = m_Allocation.RendererID;
+	if (data)
+		heap.Upload(m_Allocation, 0, data, size);
+}
+
+VertexBuffer::~VertexBuffer()
+{
+	if (m_Heap)
+		m_Heap->Free(m_Allocation);
+	else if (m_Owned)
+	{
+		GLState::OnDeleteBuffer(m_RendererID);
+		glDeleteBuffers(1, &m_RendererID);
+	}
+}
+
+unsigned int VertexBuffer::GetGLUsage(BufferUsage usage)
+{
+	switch (usage)
+	{
+		case BufferUsage::Static: return GL_STATIC_DRAW;
+		case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+		case BufferUsage::Stream: return GL_STREAM_DRAW;
+	}
+	return GL_STATIC_DRAW;
+}
+
+void VertexBuffer::Update(unsigned int offset, const void* data, unsigned int size)
+{
+	if (!m_Owned && !m_Heap)
+	{
+		std::cout << "Warning: RingBuffer를 감싼 VertexBuffer는 RingBuffer::Allocate로 써야 함\n";
+		return;
+	}
+	if (offset + size > m_Size)
+	{
+		std::cout << "Warning: VertexBuffer::Update out of range(" << offset << " + " << size << " > " << m_Size << ")\n";
+		return;
+	}
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	glBufferSubData(GL_ARRAY_BUFFER, m_Allocation.Offset + offset, size, data);
+}
+
+void VertexBuffer::Orphan(const void* data, unsigned int size)
+{
+	if (!m_Owned || m_Heap)
+	{
+		std::cout << "Warning: RingBuffer/GpuHeap 안의 VertexBuffer는 버퍼 전체를 교체할 수 없음\n";
+		return;
+	}
+	//크기가 같으면 드라이버가 이전 저장소를 재활용할 수 있음. 더 크면 버퍼가 커짐
+	if (size > m_Size)
+		m_Size = size;
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GetGLUsage(m_Usage));
+	if (data)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+	m_StreamHead = size;
+}
+
+unsigned int VertexBuffer::Stream(const void* data, unsigned int size)
+{
+	if (!m_Owned || m_Heap)
+	{
+		std::cout << "Warning: RingBuffer/GpuHeap 안의 VertexBuffer는 버퍼 전체를 교체할 수 없음\n";
+		return 0;
+	}
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+	if (m_StreamHead + size > m_Size) //끝까지 썼으면 새 저장소로 교체. 이전 저장소를 읽는 draw는 그대로 진행됨
+	{
+		if (size > m_Size) //한번에 쓰는 양이 버퍼보다 크면 키움
+			m_Size = size;
+		glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GetGLUsage(m_Usage));
+		m_StreamHead = 0;
+	}
+
+	unsigned int offset = m_StreamHead;
+	//UNSYNCHRONIZED: 드라이버가 이 범위를 읽는 draw가 끝나기를 기다리지 않음(아직 쓰지 않은 범위이므로 안전)
+	void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (!ptr)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+	}
+	else
+	{
+		std::memcpy(ptr, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	m_StreamHead += size;
+	return offset;
+}
+
+void VertexBuffer::Bind() const
+{
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID); //바인딩("작업 상태")
+}
+
+void VertexBuffer::Unbind() const
+{
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0); //언바인딩
+}
@@ -0,0 +1,283 @@
+
+// VertexBufferLayout.h
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <assert.h>
+
+//Layout별로, 데이터를 어떻게 읽어와야 하는지에 대한 정보를 가지고있는 구조체
+struct VertexBufferElement
+{
+	unsigned int type; //각 데이터 타입이 무엇인지 (ex, vertex의 위치면 float)
+	unsigned int count; //데이터가 몇 개인지
+	unsigned char normalized; //데이터의 normalization이 필요한지
+
+	static unsigned int GetSizeOfType(unsigned int type) //타입별로 적절한 메모리 사이즈를 반환하는 static 함수
+	{
+		switch (type)
+		{
+			case GL_FLOAT: return 4;
+			case GL_UNSIGNED_INT: return 4;
+			case GL_UNSIGNED_BYTE: return 1;
+			case GL_HALF_FLOAT: return 2;
+			case GL_SHORT: return 2;
+			case GL_UNSIGNED_SHORT: return 2;
+			case GL_BYTE: return 1;
+			case GL_INT_2_10_10_10_REV: return 4; //4개 성분이 합쳐서 4 byte
+		}
+		assert(0);
+		return 0;
+	}
+
+	//element 하나(vertex 하나 안에서)의 byte 크기. packed 타입은 성분 수와 상관없이 타입 크기 하나
+	unsigned int GetSize() const
+	{
+		if (type == GL_INT_2_10_10_10_REV)
+			return GetSizeOfType(type);
+		return count * GetSizeOfType(type);
+	}
+
+	//attribute location 하나는 성분 4개까지. 4개를 넘으면(mat4 = float 16개 등) 4개씩 나눠서 연속된 location을 차지함(열 하나에 location 하나)
+	static unsigned int GetLocationCount(unsigned int type, unsigned int count)
+	{
+		if (type == GL_INT_2_10_10_10_REV || count <= 4)
+			return 1;
+		assert(count % 4 == 0 && "attributes wider than 4 components must be vec4 columns (mat4 = 16 floats)");
+		return count / 4;
+	}
+	unsigned int GetLocationCount() const { return GetLocationCount(type, count); }
+};
+
+//float 대신 저장할 수 있는 압축 타입. 변환은 VertexQuantize.h 참고
+struct Half { unsigned short Bits; }; //GL_HALF_FLOAT(16bit float)
+struct Snorm1010102 { unsigned int Bits; }; //GL_INT_2_10_10_10_REV, normalized. xyz 10bit + w 2bit, normal/tangent용
+
+template<unsigned int N>
+struct StaticVertexLayout;
+
+class VertexBufferLayout
+{
+private:
+	std::vector<VertexBufferElement> m_Elements; //하나의 layout은 여러개의 element를 갖고 있음(ex, position, normal, color, etc...)
+	unsigned int m_Stride; //vertex하나당 데이터가 얼마나 떨어져있는지 stride를 멤버변수로 갖고 있음
+	unsigned int m_Divisor; //0이면 vertex마다, N이면 instance N개마다 다음 원소를 읽음(glVertexAttribDivisor)
+
+public:
+	VertexBufferLayout()
+		: m_Stride{ 0 }, m_Divisor{ 0 }
+	{}
+	//컴파일 타임 layout(아래 StaticVertexLayout)을 VertexWeld/VertexQuantize 등 runtime layout이 필요한 곳에 넘길 때 사용
+	template<unsigned int N>
+	explicit VertexBufferLayout(const StaticVertexLayout<N>& layout);
+
+	//지원하지 않는 타입이면 컴파일 에러(static_assert(false)는 템플릿이 쓰이지 않아도 에러가 나므로 T에 의존하는 조건 사용)
+	template<typename T>
+	void Push(unsigned int count)
+	{
+		static_assert(sizeof(T) == 0, "unsupported vertex element type");
+	}
+
+	//타입을 직접 지정. template 버전은 이 함수를 사용
+	void Push(unsigned int type, unsigned int count, bool normalized)
+	{
+		m_Elements.push_back({ type, count, (unsigned char)(normalized ? GL_TRUE : GL_FALSE) });
+		m_Stride += m_Elements.back().GetSize();
+	}
+
+	inline const std::vector<VertexBufferElement>& GetElement() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+
+	//instance마다 읽는 stream(transform, color 등)이면 1. VertexArray::AddBuffer/SetFormat이 이 값으로 divisor를 설정
+	inline void SetDivisor(unsigned int divisor) { m_Divisor = divisor; }
+	inline unsigned int GetDivisor() const { return m_Divisor; }
+	//element들이 차지하는 attribute location 수
+	unsigned int GetLocationCount() const
+	{
+		unsigned int locations = 0;
+		for (const VertexBufferElement& element : m_Elements)
+			locations += element.GetLocationCount();
+		return locations;
+	}
+
+	//element 타입/개수/normalized와 stride로 만든 해시. 같은 형식의 layout을 쓰는 mesh끼리 VAO를 공유할 때 사용(VertexArrayCache)
+	uint64_t GetHash() const
+	{
+		uint64_t hash = 14695981039346656037ull; //FNV-1a
+		auto mix = [&hash](unsigned int value)
+		{
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		for (const VertexBufferElement& element : m_Elements)
+		{
+			mix(element.type);
+			mix(element.count);
+			mix(element.normalized);
+		}
+		mix(m_Stride);
+		mix(m_Divisor);
+		return hash;
+	}
+
+	bool operator==(const VertexBufferLayout& other) const
+	{
+		if (m_Stride != other.m_Stride || m_Divisor != other.m_Divisor || m_Elements.size() != other.m_Elements.size())
+			return false;
+		for (unsigned int i = 0; i < m_Elements.size(); i++)
+		{
+			const VertexBufferElement& a = m_Elements[i];
+			const VertexBufferElement& b = other.m_Elements[i];
+			if (a.type != b.type || a.count != b.count || a.normalized != b.normalized)
+				return false;
+		}
+		return true;
+	}
+	bool operator!=(const VertexBufferLayout& other) const { return !(*this == other); }
+};
+
+//template specializations(클래스 안에서는 명시적 특수화를 할 수 없으므로 밖에서 정의)
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count)
+{
+	m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT); //vertex 하나당 float 데이터가 count개 추가될수록, count * size(GL_FLOAT)씩 stride가 커져야 함
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT); //위와 마찬가지
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+}
+
+//아래 타입들은 shader에서 float(vec)로 읽힘. 정수 타입은 normalized(snorm: [-1, 1])
+template<>
+inline void VertexBufferLayout::Push<Half>(unsigned int count)
+{
+	Push(GL_HALF_FLOAT, count, false);
+}
+
+template<>
+inline void VertexBufferLayout::Push<short>(unsigned int count)
+{
+	Push(GL_SHORT, count, true);
+}
+
+template<>
+inline void VertexBufferLayout::Push<signed char>(unsigned int count)
+{
+	Push(GL_BYTE, count, true);
+}
+
+//count는 shader에서 읽을 성분 수(GL에서는 4만 허용)
+template<>
+inline void VertexBufferLayout::Push<Snorm1010102>(unsigned int count)
+{
+	assert(count == 4 && "GL_INT_2_10_10_10_REV needs 4 components");
+	Push(GL_INT_2_10_10_10_REV, count, true);
+}
+
+//---------컴파일 타임 layout--------//
+//vertex 구조체의 멤버에서 타입/개수/offset/stride를 컴파일 타임에 계산. 힙 할당 없이 VertexArray::AddBuffer<Vertex>()에서 사용
+//  struct Vertex { float Position[3]; Half TexCoord[2]; ... };
+//  DEFINE_VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, Position), VERTEX_ATTRIBUTE(Vertex, TexCoord), ...);
+//멤버를 빠뜨리거나 순서가 다르거나 padding이 있으면 컴파일 에러
+//instance stream의 행렬은 float Transform[16](열 우선)으로 선언하면 location 4개(vec4 열)로 나뉘어 shader의 mat4 하나로 읽힘
+
+//멤버 타입 -> GL 타입. 특수화가 없는 타입은 정의되지 않은 템플릿이므로 컴파일 에러
+template<typename T>
+struct VertexAttributeType;
+
+template<> struct VertexAttributeType<float> { static constexpr unsigned int Type = GL_FLOAT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<unsigned int> { static constexpr unsigned int Type = GL_UNSIGNED_INT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<unsigned char> { static constexpr unsigned int Type = GL_UNSIGNED_BYTE, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttributeType<Half> { static constexpr unsigned int Type = GL_HALF_FLOAT, Count = 1; static constexpr bool Normalized = false; };
+template<> struct VertexAttributeType<short> { static constexpr unsigned int Type = GL_SHORT, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttributeType<signed char> { static constexpr unsigned int Type = GL_BYTE, Count = 1; static constexpr bool Normalized = true; };
+template<> struct VertexAttributeType<Snorm1010102> { static constexpr unsigned int Type = GL_INT_2_10_10_10_REV, Count = 4; static constexpr bool Normalized = true; };
+
+//배열 멤버(float Position[3] 등)는 원소 타입 x 개수
+template<typename T, size_t N>
+struct VertexAttributeType<T[N]>
+{
+	static_assert(VertexAttributeType<T>::Count == 1, "packed attribute types cannot be used as arrays");
+	static constexpr unsigned int Type = VertexAttributeType<T>::Type, Count = (unsigned int)N;
+	static constexpr bool Normalized = VertexAttributeType<T>::Normalized;
+};
+
+struct VertexAttribute
+{
+	unsigned int type;
+	unsigned int count;
+	unsigned char normalized;
+	unsigned int offset; //vertex 시작부터의 byte 위치
+	unsigned int size; //멤버의 byte 크기
+
+	unsigned int GetLocationCount() const { return VertexBufferElement::GetLocationCount(type, count); }
+};
+
+template<typename T>
+constexpr VertexAttribute MakeVertexAttribute(size_t offset)
+{
+	return { VertexAttributeType<T>::Type, VertexAttributeType<T>::Count,
+		(unsigned char)(VertexAttributeType<T>::Normalized ? GL_TRUE : GL_FALSE), (unsigned int)offset, (unsigned int)sizeof(T) };
+}
+
+template<unsigned int N>
+struct StaticVertexLayout
+{
+	VertexAttribute Attributes[N];
+	unsigned int Stride; //마지막 attribute의 끝
+	bool Contiguous; //attribute들이 나열한 순서대로 빈틈 없이 이어지는지
+
+	static constexpr unsigned int Count = N;
+};
+
+template<typename... T>
+constexpr StaticVertexLayout<sizeof...(T)> MakeVertexLayout(const T&... attributes)
+{
+	StaticVertexLayout<sizeof...(T)> layout{ { attributes... }, 0, true };
+	for (unsigned int i = 0; i < layout.Count; i++)
+	{
+		if (layout.Attributes[i].offset != layout.Stride)
+			layout.Contiguous = false;
+		layout.Stride = layout.Attributes[i].offset + layout.Attributes[i].size;
+	}
+	return layout;
+}
+
+//DEFINE_VERTEX_LAYOUT으로 vertex 구조체마다 특수화
+template<typename Vertex>
+struct VertexLayoutOf;
+
+#define VERTEX_ATTRIBUTE(Vertex, Member) MakeVertexAttribute<decltype(Vertex::Member)>(offsetof(Vertex, Member))
+
+#define DEFINE_VERTEX_LAYOUT(Vertex, ...) \
+	template<> \
+	struct VertexLayoutOf<Vertex> \
+	{ \
+		static constexpr auto Value = MakeVertexLayout(__VA_ARGS__); \
+		static_assert(Value.Contiguous, #Vertex ": attributes must be listed in member order without gaps"); \
+		static_assert(Value.Stride == sizeof(Vertex), #Vertex ": layout stride does not match sizeof (missing member or padding)"); \
+	}
+
+template<unsigned int N>
+VertexBufferLayout::VertexBufferLayout(const StaticVertexLayout<N>& layout)
+	: m_Stride{ 0 }, m_Divisor{ 0 }
+{
+	for (const VertexAttribute& attribute : layout.Attributes)
+		Push(attribute.type, attribute.count, attribute.normalized == GL_TRUE);
+	assert(m_Stride == layout.Stride);
+}
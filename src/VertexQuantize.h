@@ -0,0 +1,369 @@
+
+// VertexQuantize.h
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <assert.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_QUANTIZE_SSE2 1
+#include <emmintrin.h>
+#else
+#define VERTEX_QUANTIZE_SSE2 0
+#endif
+
+#include "VertexBufferLayout.h"
+
+//Quantize()에서 각 element를 어떤 형식으로 저장할지
+enum class VertexFormat
+{
+	Float, //그대로 복사(float가 아닌 element도 가능)
+	Half, //GL_HALF_FLOAT. 유효숫자 11bit(상대 오차 약 1/2048)이므로 원점에서 먼 큰 좌표의 position에는 맞지 않음
+	Snorm16, //GL_SHORT normalized, [-1, 1]
+	Snorm1010102, //GL_INT_2_10_10_10_REV normalized, 4 byte. normal/tangent(w에 handedness)
+	Octahedral16, //단위 벡터를 2개의 snorm16으로(4 byte). shader에서 DecodeOctahedral()로 복원해야 함
+};
+
+//업로드 전에 float vertex 데이터를 작은 형식으로 바꾸는 변환 함수들. 4개씩 SSE2로 처리하고 나머지는 scalar로 처리.
+//예) position(float3) + normal(float3) + uv(float2) = 32 byte -> Half(4) + Snorm1010102 + Half(2) = 16 byte
+//
+//Octahedral16을 쓸 때 shader에서 복원:
+//  vec3 DecodeOctahedral(vec2 e)
+//  {
+//      vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+//      float t = max(-n.z, 0.0);
+//      n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+//      return normalize(n);
+//  }
+class VertexQuantize
+{
+public:
+	static unsigned short FloatToHalf(float value);
+	static float HalfToFloat(unsigned short value);
+	static short FloatToSnorm16(float value);
+
+	//count개의 float를 연속된 배열로 변환
+	static void FloatToHalf(const float* source, Half* destination, size_t count);
+	static void FloatToSnorm16(const float* source, short* destination, size_t count);
+	//normals: vertex마다 float 3개, stride는 byte 단위. destination에는 normal마다 short 2개
+	static void EncodeOctahedral(const float* normals, unsigned int stride, short* destination, size_t count);
+	//vectors: vertex마다 float components(3 또는 4)개. 3개면 w는 0
+	static void PackSnorm1010102(const float* vectors, unsigned int stride, unsigned int components, Snorm1010102* destination, size_t count);
+
+	//layout으로 기술된 interleaved vertex를 element마다 formats대로 변환해서 out에 쓰고, 새 layout을 반환.
+	//Float가 아닌 형식은 float element만 가능. 각 element는 4 byte 단위로 정렬되도록 성분을 채움(Half 3개 -> 4개, 채운 성분은 1.0)
+	static VertexBufferLayout Quantize(const void* vertices, unsigned int vertexCount, const VertexBufferLayout& layout,
+		const std::vector<VertexFormat>& formats, std::vector<unsigned char>& out);
+private:
+	static unsigned int PaddedCount(VertexFormat format, unsigned int count);
+};
+
+// VertexQuantize.cpp
+
+unsigned short VertexQuantize::FloatToHalf(float value)
+{
+	//round-to-nearest-even. 아래 SSE2 버전과 같은 방식
+	uint32_t bits;
+	std::memcpy(&bits, &value, 4);
+	uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	uint32_t result;
+	if (bits >= (127u + 16u) << 23) //half로 표현할 수 없는 큰 값, inf, NaN
+		result = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	else if (bits < (127u - 14u) << 23) //half에서는 subnormal: 더해서 mantissa를 반올림한 뒤 다시 빼줌
+	{
+		const uint32_t magicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+		float magic, rounded;
+		std::memcpy(&magic, &magicBits, 4);
+		std::memcpy(&rounded, &bits, 4);
+		rounded += magic;
+		std::memcpy(&result, &rounded, 4);
+		result -= magicBits;
+	}
+	else
+	{
+		uint32_t mantissaOdd = (bits >> 13) & 1;
+		bits += ((15u - 127u) << 23) + 0xFFFu + mantissaOdd; //exponent bias를 바꾸고 반올림
+		result = bits >> 13;
+	}
+	return (unsigned short)(result | (sign >> 16));
+}
+
+float VertexQuantize::HalfToFloat(unsigned short value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0x1F)
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	else if (exponent == 0)
+	{
+		float f = mantissa * (1.0f / 16777216.0f); //subnormal: mantissa * 2^-24
+		std::memcpy(&bits, &f, 4);
+		bits |= sign;
+	}
+	else
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	float result;
+	std::memcpy(&result, &bits, 4);
+	return result;
+}
+
+short VertexQuantize::FloatToSnorm16(float value)
+{
+	value = std::max(-1.0f, std::min(1.0f, value));
+	return (short)std::lrint(value * 32767.0f);
+}
+
+void VertexQuantize::FloatToHalf(const float* source, Half* destination, size_t count)
+{
+	size_t i = 0;
+#if VERTEX_QUANTIZE_SSE2
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128i halfMax = _mm_set1_epi32((127 + 16) << 23);
+	const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+	const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+	const __m128i nanBit = _mm_set1_epi32(0x200);
+	const __m128i infinity = _mm_set1_epi32(0x7C00);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i halves[2];
+		for (int h = 0; h < 2; h++)
+		{
+			__m128 value = _mm_loadu_ps(source + i + h * 4);
+			__m128 sign = _mm_and_ps(value, signMask);
+			__m128 absolute = _mm_xor_ps(value, sign);
+			__m128i bits = _mm_castps_si128(absolute);
+
+			__m128i isRegular = _mm_cmpgt_epi32(halfMax, bits);
+			__m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+			__m128i special = _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absolute, absolute)), nanBit), infinity);
+
+			__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+			__m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31); //홀수면 -1
+			__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd), 13);
+
+			__m128i result = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+			result = _mm_or_si128(_mm_and_si128(isRegular, result), _mm_andnot_si128(isRegular, special));
+			halves[h] = _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16)); //부호가 있으면 0xFFFF8000 | x가 되어 pack해도 하위 16bit 유지
+		}
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi32(halves[0], halves[1]));
+	}
+#endif
+	for (; i < count; i++)
+		destination[i].Bits = FloatToHalf(source[i]);
+}
+
+void VertexQuantize::FloatToSnorm16(const float* source, short* destination, size_t count)
+{
+	size_t i = 0;
+#if VERTEX_QUANTIZE_SSE2
+	const __m128 one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 a = _mm_max_ps(minusOne, _mm_min_ps(one, _mm_loadu_ps(source + i)));
+		__m128 b = _mm_max_ps(minusOne, _mm_min_ps(one, _mm_loadu_ps(source + i + 4)));
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = FloatToSnorm16(source[i]);
+}
+
+void VertexQuantize::EncodeOctahedral(const float* normals, unsigned int stride, short* destination, size_t count)
+{
+	const unsigned char* data = (const unsigned char*)normals;
+	size_t i = 0;
+#if VERTEX_QUANTIZE_SSE2
+	const __m128 signMask = _mm_set1_ps(-0.0f), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+	const __m128 minLength = _mm_set1_ps(1e-20f), scale = _mm_set1_ps(32767.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		//4개의 normal을 x, y, z 별로 모음(SoA)
+		const float* n[4];
+		for (int k = 0; k < 4; k++)
+			n[k] = (const float*)(data + (i + k) * stride);
+		__m128 x = _mm_setr_ps(n[0][0], n[1][0], n[2][0], n[3][0]);
+		__m128 y = _mm_setr_ps(n[0][1], n[1][1], n[2][1], n[3][1]);
+		__m128 z = _mm_setr_ps(n[0][2], n[1][2], n[2][2], n[3][2]);
+
+		//|x| + |y| + |z| = 1인 팔면체에 투영
+		__m128 length = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+		__m128 inverse = _mm_div_ps(one, _mm_max_ps(length, minLength));
+		__m128 px = _mm_mul_ps(x, inverse), py = _mm_mul_ps(y, inverse);
+
+		//아래쪽 반구(z < 0)는 대각선 기준으로 접어서 바깥 삼각형들로 보냄
+		__m128 foldX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, py)), _mm_or_ps(_mm_and_ps(px, signMask), one));
+		__m128 foldY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, px)), _mm_or_ps(_mm_and_ps(py, signMask), one));
+		__m128 lower = _mm_cmplt_ps(z, zero);
+		px = _mm_or_ps(_mm_and_ps(lower, foldX), _mm_andnot_ps(lower, px));
+		py = _mm_or_ps(_mm_and_ps(lower, foldY), _mm_andnot_ps(lower, py));
+
+		__m128i ix = _mm_cvtps_epi32(_mm_mul_ps(px, scale)), iy = _mm_cvtps_epi32(_mm_mul_ps(py, scale));
+		__m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(ix, iy), _mm_unpackhi_epi32(ix, iy)); //x0 y0 x1 y1 ...
+		_mm_storeu_si128((__m128i*)(destination + i * 2), packed);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float* n = (const float*)(data + i * stride);
+		float length = std::max(std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]), 1e-20f);
+		float px = n[0] / length, py = n[1] / length;
+		if (n[2] < 0.0f)
+		{
+			float fx = (1.0f - std::fabs(py)) * std::copysign(1.0f, px);
+			float fy = (1.0f - std::fabs(px)) * std::copysign(1.0f, py);
+			px = fx;
+			py = fy;
+		}
+		destination[i * 2 + 0] = FloatToSnorm16(px);
+		destination[i * 2 + 1] = FloatToSnorm16(py);
+	}
+}
+
+void VertexQuantize::PackSnorm1010102(const float* vectors, unsigned int stride, unsigned int components, Snorm1010102* destination, size_t count)
+{
+	assert(components == 3 || components == 4);
+	const unsigned char* data = (const unsigned char*)vectors;
+	size_t i = 0;
+#if VERTEX_QUANTIZE_SSE2
+	const __m128 one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f);
+	const __m128 scale = _mm_set1_ps(511.0f);
+	const __m128i mask10 = _mm_set1_epi32(0x3FF), mask2 = _mm_set1_epi32(0x3);
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* v[4];
+		for (int k = 0; k < 4; k++)
+			v[k] = (const float*)(data + (i + k) * stride);
+		__m128 x = _mm_setr_ps(v[0][0], v[1][0], v[2][0], v[3][0]);
+		__m128 y = _mm_setr_ps(v[0][1], v[1][1], v[2][1], v[3][1]);
+		__m128 z = _mm_setr_ps(v[0][2], v[1][2], v[2][2], v[3][2]);
+		__m128 w = components == 4 ? _mm_setr_ps(v[0][3], v[1][3], v[2][3], v[3][3]) : _mm_setzero_ps();
+
+		auto quantize = [&](__m128 value, __m128 range, __m128i mask)
+		{
+			value = _mm_max_ps(minusOne, _mm_min_ps(one, value));
+			return _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(value, range)), mask); //2의 보수 하위 bit만 남김
+		};
+		__m128i packed = quantize(x, scale, mask10);
+		packed = _mm_or_si128(packed, _mm_slli_epi32(quantize(y, scale, mask10), 10));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(quantize(z, scale, mask10), 20));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(quantize(w, one, mask2), 30));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const float* v = (const float*)(data + i * stride);
+		auto quantize = [](float value, float range, unsigned int mask)
+		{
+			value = std::max(-1.0f, std::min(1.0f, value));
+			return (unsigned int)(int)std::lrint(value * range) & mask;
+		};
+		float w = components == 4 ? v[3] : 0.0f;
+		destination[i].Bits = quantize(v[0], 511.0f, 0x3FF) | (quantize(v[1], 511.0f, 0x3FF) << 10)
+			| (quantize(v[2], 511.0f, 0x3FF) << 20) | (quantize(w, 1.0f, 0x3) << 30);
+	}
+}
+
+unsigned int VertexQuantize::PaddedCount(VertexFormat format, unsigned int count)
+{
+	switch (format)
+	{
+		case VertexFormat::Half: return (count + 1) & ~1u; //2 byte 성분은 짝수개
+		case VertexFormat::Snorm16: return (count + 1) & ~1u;
+		case VertexFormat::Snorm1010102: return 4;
+		case VertexFormat::Octahedral16: return 2;
+		default: return count;
+	}
+}
+
+VertexBufferLayout VertexQuantize::Quantize(const void* vertices, unsigned int vertexCount, const VertexBufferLayout& layout,
+	const std::vector<VertexFormat>& formats, std::vector<unsigned char>& out)
+{
+	const std::vector<VertexBufferElement>& elements = layout.GetElement();
+	assert(formats.size() == elements.size());
+
+	VertexBufferLayout quantized;
+	for (unsigned int e = 0; e < elements.size(); e++)
+	{
+		const VertexBufferElement& element = elements[e];
+		unsigned int count = PaddedCount(formats[e], element.count);
+		assert((formats[e] == VertexFormat::Float || element.type == GL_FLOAT) && "only float elements can be quantized");
+		switch (formats[e])
+		{
+			case VertexFormat::Float: quantized.Push(element.type, element.count, element.normalized == GL_TRUE); break;
+			case VertexFormat::Half: quantized.Push<Half>(count); break;
+			case VertexFormat::Snorm16: quantized.Push<short>(count); break;
+			case VertexFormat::Snorm1010102: quantized.Push<Snorm1010102>(count); break;
+			case VertexFormat::Octahedral16: quantized.Push<short>(count); break;
+		}
+	}
+
+	unsigned int sourceStride = layout.GetStride(), stride = quantized.GetStride();
+	out.resize((size_t)vertexCount * stride);
+	const unsigned char* source = (const unsigned char*)vertices;
+
+	//vertex를 block 단위로 element마다 연속된 float 배열로 모아서 변환한 뒤 interleave(임시 메모리는 block 크기만큼만 사용)
+	const unsigned int blockSize = 1024;
+	std::vector<float> gathered;
+	std::vector<unsigned char> converted;
+	unsigned int sourceOffset = 0, offset = 0;
+	for (unsigned int e = 0; e < elements.size(); e++)
+	{
+		const VertexBufferElement& element = elements[e];
+		const VertexBufferElement& target = quantized.GetElement()[e];
+		unsigned int size = target.GetSize();
+		for (unsigned int first = 0; first < vertexCount; first += blockSize)
+		{
+			unsigned int n = std::min(blockSize, vertexCount - first);
+			const unsigned char* base = source + (size_t)first * sourceStride + sourceOffset;
+			converted.resize((size_t)n * size);
+			switch (formats[e])
+			{
+				case VertexFormat::Float:
+					for (unsigned int v = 0; v < n; v++)
+						std::memcpy(&converted[(size_t)v * size], base + (size_t)v * sourceStride, size);
+					break;
+				case VertexFormat::Half:
+				case VertexFormat::Snorm16:
+					gathered.resize((size_t)n * target.count);
+					for (unsigned int v = 0; v < n; v++)
+					{
+						float* to = &gathered[(size_t)v * target.count];
+						std::memcpy(to, base + (size_t)v * sourceStride, element.count * sizeof(float));
+						std::fill(to + element.count, to + target.count, 1.0f); //정렬을 위해 채운 성분
+					}
+					if (formats[e] == VertexFormat::Half)
+						FloatToHalf(gathered.data(), (Half*)converted.data(), gathered.size());
+					else
+						FloatToSnorm16(gathered.data(), (short*)converted.data(), gathered.size());
+					break;
+				case VertexFormat::Snorm1010102:
+					assert(element.count == 3 || element.count == 4);
+					PackSnorm1010102((const float*)base, sourceStride, element.count, (Snorm1010102*)converted.data(), n);
+					break;
+				case VertexFormat::Octahedral16:
+					assert(element.count == 3);
+					EncodeOctahedral((const float*)base, sourceStride, (short*)converted.data(), n);
+					break;
+			}
+			unsigned char* destination = out.data() + (size_t)first * stride + offset;
+			for (unsigned int v = 0; v < n; v++)
+				std::memcpy(destination + (size_t)v * stride, &converted[(size_t)v * size], size);
+		}
+		sourceOffset += element.GetSize();
+		offset += size;
+	}
+	return quantized;
+}
@@ -0,0 +1,339 @@
+
+// VertexWeld.h
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+#include "VertexBufferLayout.h"
+
+//Weld 전후 크기
+struct VertexWeldReport
+{
+	unsigned int VertexCountBefore = 0;
+	unsigned int VertexCountAfter = 0;
+	size_t BytesBefore = 0;
+	size_t BytesAfter = 0;
+	unsigned int Partitions = 0;
+	unsigned int Threads = 0;
+};
+
+//interleaved vertex 배열에서 같은 vertex를 하나로 합치고 index를 다시 씀(중복 제거).
+//VertexBufferLayout의 element 단위로 비교: float는 epsilon > 0이면 대표 vertex와 모든 성분의 차이가 epsilon 이하일 때, 나머지는 bit 단위로 같을 때 같은 vertex.
+//epsilon으로 비교할 때는 앞쪽 float 성분 4개를 격자 칸(epsilon의 s_CellScale배)으로 해시하고, 칸 경계에서 epsilon 안쪽인 성분은 이웃 칸도 찾아봄
+//
+//메모리: vertex당 해시/순서/remap 배열 4 byte씩 + open addressing 표(스레드마다, 찾은 서로 다른 vertex 수의 2배까지 커짐)만 사용하고, vertex 데이터는 제자리에서 압축.
+//epsilon = 0이면 해시 상위 bit로 partition을 나누므로 같은 vertex는 항상 같은 partition에 들어가고, partition들은 여러 스레드가 나눠서 독립적으로 처리.
+//표는 partition 안의 서로 다른 vertex 수만큼만 커지므로 중복이 많은 입력이 한 partition에 몰려도 표는 작음.
+//epsilon > 0이면 이웃 칸이 다른 partition에 있을 수 있으므로 partition 하나(스레드 하나)로 중복을 찾음(해시와 index 다시 쓰기는 여러 스레드)
+class VertexWeld
+{
+public:
+	//vertices는 제자리에서 수정되고, 반환된 report.VertexCountAfter 개수까지만 유효. 남는 vertex의 순서는 원래 순서를 유지
+	static VertexWeldReport Weld(std::vector<unsigned int>& indices, void* vertices, unsigned int vertexCount,
+		const VertexBufferLayout& layout, float epsilon = 0.0f, unsigned int threads = 0);
+private:
+	struct Context
+	{
+		const unsigned char* Vertices;
+		unsigned int Stride;
+		const std::vector<VertexBufferElement>* Elements;
+		float Epsilon;
+	};
+
+	static constexpr unsigned int s_CellComponents = 4; //격자로 해시하는 float 성분 수(이웃 칸 조합은 최대 2^4)
+	static constexpr float s_CellScale = 8.0f; //칸 크기 / epsilon. 성분이 경계 근처(epsilon 이내)일 확률은 2 / s_CellScale
+
+	//neighbours의 bit i가 켜져 있으면 격자 성분 i를 가까운 쪽 이웃 칸으로 바꿔서 해시. nearBoundary에는 칸 경계에서 epsilon 안쪽인 격자 성분을 표시
+	static uint32_t HashVertex(const Context& context, unsigned int vertex, uint32_t neighbours = 0, uint32_t* nearBoundary = nullptr);
+	static bool EqualVertex(const Context& context, unsigned int a, unsigned int b);
+	static void ParallelFor(unsigned int threads, unsigned int count, const std::function<void(unsigned int begin, unsigned int end)>& body);
+};
+
+// VertexWeld.cpp
+
+uint32_t VertexWeld::HashVertex(const Context& context, unsigned int vertex, uint32_t neighbours, uint32_t* nearBoundary)
+{
+	//4 byte씩 섞는 해시(murmur3의 mix 단계). FNV처럼 byte 단위로 돌면 천만 개 단위에서 너무 느림
+	auto mix = [](uint32_t hash, uint32_t word)
+	{
+		word *= 0xcc9e2d51u;
+		word = (word << 15) | (word >> 17);
+		word *= 0x1b873593u;
+		hash ^= word;
+		hash = (hash << 13) | (hash >> 19);
+		return hash * 5 + 0xe6546b64u;
+	};
+
+	const unsigned char* data = context.Vertices + (size_t)vertex * context.Stride;
+	uint32_t hash = 0x9747b28cu;
+	unsigned int cellComponent = 0;
+	if (nearBoundary)
+		*nearBoundary = 0;
+	for (const VertexBufferElement& element : *context.Elements)
+	{
+		unsigned int size = element.GetSize();
+		if (element.type == GL_FLOAT && context.Epsilon > 0.0f)
+		{
+			//float는 격자 칸 번호만 해시(칸이 다르면 EqualVertex가 같다고 해도 못 찾으므로 이웃 칸은 neighbours로 따로 찾음)
+			float cellSize = context.Epsilon * s_CellScale;
+			for (unsigned int i = 0; i < element.count && cellComponent < s_CellComponents; i++, cellComponent++)
+			{
+				float value;
+				std::memcpy(&value, data + i * 4, 4);
+				double scaled = (double)value / cellSize;
+				if (!(std::fabs(scaled) < 9e15)) //inf, NaN, 너무 큰 값은 bit 그대로(EqualVertex에서도 같은 값끼리만 같음)
+				{
+					uint32_t bits;
+					std::memcpy(&bits, &value, 4);
+					hash = mix(hash, bits);
+					continue;
+				}
+				double cell = std::floor(scaled);
+				double fraction = scaled - cell;
+				bool upper = fraction >= 0.5;
+				if ((upper ? 1.0 - fraction : fraction) * s_CellScale <= 1.001) //가까운 경계까지 epsilon 이하(반올림 오차만큼 여유)
+				{
+					if (nearBoundary)
+						*nearBoundary |= 1u << cellComponent;
+					if (neighbours & (1u << cellComponent))
+						cell += upper ? 1.0 : -1.0;
+				}
+				int64_t snapped = (int64_t)cell;
+				hash = mix(hash, (uint32_t)snapped);
+				hash = mix(hash, (uint32_t)(snapped >> 32));
+			}
+		}
+		else
+		{
+			unsigned int i = 0;
+			for (; i + 4 <= size; i += 4)
+			{
+				uint32_t word;
+				std::memcpy(&word, data + i, 4);
+				hash = mix(hash, word);
+			}
+			for (; i < size; i++)
+				hash = mix(hash, data[i]);
+		}
+		data += size;
+	}
+
+	hash ^= hash >> 16; //마무리(fmix32)
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	return hash ^ (hash >> 16);
+}
+
+bool VertexWeld::EqualVertex(const Context& context, unsigned int a, unsigned int b)
+{
+	const unsigned char* pa = context.Vertices + (size_t)a * context.Stride;
+	const unsigned char* pb = context.Vertices + (size_t)b * context.Stride;
+	if (context.Epsilon <= 0.0f)
+		return std::memcmp(pa, pb, context.Stride) == 0;
+
+	for (const VertexBufferElement& element : *context.Elements)
+	{
+		unsigned int size = element.GetSize();
+		if (element.type == GL_FLOAT)
+		{
+			for (unsigned int i = 0; i < element.count; i++)
+			{
+				float va, vb;
+				std::memcpy(&va, pa + i * 4, 4);
+				std::memcpy(&vb, pb + i * 4, 4);
+				if (va != vb && !(std::fabs(va - vb) <= context.Epsilon)) //같은 inf끼리는 같음, NaN은 항상 다름
+					return false;
+			}
+		}
+		else if (std::memcmp(pa, pb, size) != 0)
+			return false;
+		pa += size;
+		pb += size;
+	}
+	return true;
+}
+
+void VertexWeld::ParallelFor(unsigned int threads, unsigned int count, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	std::vector<std::thread> workers;
+	unsigned int chunk = (count + threads - 1) / threads;
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		unsigned int begin = t * chunk, end = std::min(count, begin + chunk);
+		if (begin >= end)
+			break;
+		workers.emplace_back(body, begin, end);
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+VertexWeldReport VertexWeld::Weld(std::vector<unsigned int>& indices, void* vertices, unsigned int vertexCount,
+	const VertexBufferLayout& layout, float epsilon, unsigned int threads)
+{
+	VertexWeldReport report;
+	unsigned int stride = layout.GetStride();
+	report.VertexCountBefore = report.VertexCountAfter = vertexCount;
+	report.BytesBefore = report.BytesAfter = (size_t)vertexCount * stride + indices.size() * sizeof(unsigned int);
+	if (vertexCount == 0 || stride == 0)
+		return report;
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	if (vertexCount < 65536) //작은 mesh는 스레드를 만드는 비용이 더 큼
+		threads = 1;
+
+	Context context{ (const unsigned char*)vertices, stride, &layout.GetElement(), epsilon };
+
+	//1. vertex마다 해시
+	std::vector<uint32_t> hashes(vertexCount);
+	ParallelFor(threads, vertexCount, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int v = begin; v < end; v++)
+			hashes[v] = HashVertex(context, v);
+	});
+
+	//2. 해시 상위 bit로 partition을 나눔(counting sort). partition 하나가 대략 64K vertex가 되도록
+	//epsilon > 0이면 이웃 칸의 해시가 다른 partition에 있을 수 있으므로 partition 하나
+	unsigned int partitionBits = 0;
+	while (epsilon <= 0.0f && partitionBits < 12 && (vertexCount >> partitionBits) > 65536)
+		partitionBits++;
+	unsigned int partitionCount = 1u << partitionBits;
+	auto partitionOf = [&](unsigned int v) { return partitionBits ? hashes[v] >> (32 - partitionBits) : 0u; };
+
+	std::vector<unsigned int> partitionStart(partitionCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		partitionStart[partitionOf(v) + 1]++;
+	for (unsigned int p = 0; p < partitionCount; p++)
+		partitionStart[p + 1] += partitionStart[p];
+	std::vector<unsigned int> order(vertexCount); //partition 순으로 정렬한 vertex 번호(partition 안에서는 원래 순서)
+	{
+		std::vector<unsigned int> fill(partitionStart.begin(), partitionStart.end() - 1);
+		for (unsigned int v = 0; v < vertexCount; v++)
+			order[fill[partitionOf(v)]++] = v;
+	}
+
+	//3. partition마다 open addressing(linear probing) 표로 중복을 찾음. 같은 vertex 중 가장 먼저 나온 vertex가 대표
+	//표에는 대표 vertex만 자기 해시 위치에 들어가고, 대표 수가 capacity의 절반을 넘으면 두 배로 늘림
+	std::vector<unsigned int> remap(vertexCount);
+	std::atomic<unsigned int> nextPartition{ 0 };
+	auto worker = [&]()
+	{
+		std::vector<unsigned int> table;
+		unsigned int slot = 0; //find가 멈춘 빈 칸(못 찾았을 때 v를 넣을 곳)
+		auto find = [&](uint32_t hash, unsigned int v)
+		{
+			unsigned int capacity = (unsigned int)table.size();
+			for (slot = hash & (capacity - 1); table[slot] != 0xFFFFFFFF; slot = (slot + 1) & (capacity - 1))
+			{
+				unsigned int other = table[slot];
+				if (hashes[other] == hash && EqualVertex(context, other, v))
+					return other;
+			}
+			return 0xFFFFFFFFu;
+		};
+		auto insert = [&](unsigned int v)
+		{
+			unsigned int capacity = (unsigned int)table.size();
+			unsigned int slot = hashes[v] & (capacity - 1);
+			while (table[slot] != 0xFFFFFFFF)
+				slot = (slot + 1) & (capacity - 1);
+			table[slot] = v;
+		};
+
+		unsigned int partition;
+		while ((partition = nextPartition++) < partitionCount)
+		{
+			//처음 크기는 partition 인구와 평균 partition 인구 중 작은 쪽 기준. 중복이 몰린 partition은 서로 다른 vertex가 늘어날 때만 커짐
+			unsigned int begin = partitionStart[partition], end = partitionStart[partition + 1];
+			unsigned int capacity = 16;
+			while (capacity < std::min(end - begin, vertexCount / partitionCount) * 2)
+				capacity <<= 1;
+			table.assign(capacity, 0xFFFFFFFF);
+			unsigned int unique = 0;
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				unsigned int v = order[i];
+				unsigned int other = find(hashes[v], v);
+				unsigned int emptySlot = slot;
+				if (other == 0xFFFFFFFF && epsilon > 0.0f)
+				{
+					//경계 근처 성분이 있으면 그 성분들을 이웃 칸으로 바꾼 조합마다 찾아봄
+					uint32_t nearBoundary;
+					HashVertex(context, v, 0, &nearBoundary);
+					for (uint32_t mask = nearBoundary; mask != 0 && other == 0xFFFFFFFF; mask = (mask - 1) & nearBoundary)
+						other = find(HashVertex(context, v, mask), v);
+				}
+				if (other != 0xFFFFFFFF)
+				{
+					remap[v] = other;
+					continue;
+				}
+
+				remap[v] = v;
+				if (++unique * 2 <= table.size())
+				{
+					table[emptySlot] = v;
+					continue;
+				}
+				std::vector<unsigned int> old(table.size() * 2, 0xFFFFFFFF);
+				old.swap(table);
+				for (unsigned int entry : old)
+				{
+					if (entry != 0xFFFFFFFF)
+						insert(entry);
+				}
+				insert(v);
+			}
+		}
+	};
+	{
+		std::vector<std::thread> workers;
+		for (unsigned int t = 1; t < std::min(threads, partitionCount); t++)
+			workers.emplace_back(worker);
+		worker();
+		for (std::thread& thread : workers)
+			thread.join();
+	}
+
+	//4. 대표 vertex에 원래 순서대로 새 번호를 붙이고 vertex 데이터를 앞으로 당김(새 위치 <= 원래 위치이므로 제자리에서 가능)
+	std::vector<unsigned int>& newIndex = order; //order는 더이상 필요 없으므로 재사용
+	unsigned int next = 0;
+	unsigned char* data = (unsigned char*)vertices;
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != v)
+			continue;
+		newIndex[v] = next;
+		if (next != v)
+			std::memcpy(data + (size_t)next * stride, data + (size_t)v * stride, stride);
+		next++;
+	}
+
+	//5. index 다시 쓰기
+	ParallelFor(threads, (unsigned int)indices.size(), [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			if (indices[i] < vertexCount)
+				indices[i] = newIndex[remap[indices[i]]];
+		}
+	});
+
+	report.VertexCountAfter = next;
+	report.BytesAfter = (size_t)next * stride + indices.size() * sizeof(unsigned int);
+	report.Partitions = partitionCount;
+	report.Threads = threads;
+	return report;
+}
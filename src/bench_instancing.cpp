@@ -0,0 +1,186 @@
+// Benchmark - instancing vs draw마다 uniform 업데이트
+// main08의 사각형을 100k개(위치/크기/회전/색이 모두 다름) 그리는 두 가지 방식의 frame당 시간 비교
+//  1. Uniform: 사각형마다 glUniformMatrix4fv + glUniform4fv + glDrawElements (draw call 100k번)
+//  2. Instanced: transform(mat4, location 1~4)과 color(location 5)를 instance stream으로 올리고 Renderer::DrawInstanced 한 번
+//     transform은 매 frame 바뀐다고 보고 Orphan으로 instance 버퍼 전체를 다시 올림(업로드 시간 포함)
+// 보이지 않는 창을 만들어 GL context를 얻음. vsync는 끔
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Renderer.h"
+
+using namespace std;
+
+struct QuadVertex
+{
+	float Position[2];
+};
+DEFINE_VERTEX_LAYOUT(QuadVertex, VERTEX_ATTRIBUTE(QuadVertex, Position));
+
+//instance 하나의 데이터. Transform은 열 우선 mat4(location 4개)
+struct Instance
+{
+	float Transform[16];
+	unsigned char Color[4];
+};
+DEFINE_VERTEX_LAYOUT(Instance, VERTEX_ATTRIBUTE(Instance, Transform), VERTEX_ATTRIBUTE(Instance, Color));
+
+static unsigned int CompileProgram(const char* vs, const char* fs)
+{
+	unsigned int program = glCreateProgram();
+	const char* sources[] = { vs, fs };
+	unsigned int types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (int i = 0; i < 2; i++)
+	{
+		unsigned int id = glCreateShader(types[i]);
+		glShaderSource(id, 1, &sources[i], nullptr);
+		glCompileShader(id);
+		glAttachShader(program, id);
+		glDeleteShader(id);
+	}
+	glLinkProgram(program);
+	return program;
+}
+
+static const char* s_UniformVS =
+	"#version 330 core\n"
+	"layout(location = 0) in vec2 position;\n"
+	"uniform mat4 u_Transform;\n"
+	"void main() { gl_Position = u_Transform * vec4(position, 0.0, 1.0); }\n";
+static const char* s_UniformFS = "#version 330 core\nuniform vec4 u_Color;\nout vec4 color;\nvoid main() { color = u_Color; }\n";
+
+static const char* s_InstancedVS =
+	"#version 330 core\n"
+	"layout(location = 0) in vec2 position;\n"
+	"layout(location = 1) in mat4 transform;\n" //location 1~4
+	"layout(location = 5) in vec4 instanceColor;\n"
+	"out vec4 v_Color;\n"
+	"void main() { gl_Position = transform * vec4(position, 0.0, 1.0); v_Color = instanceColor; }\n";
+static const char* s_InstancedFS = "#version 330 core\nin vec4 v_Color;\nout vec4 color;\nvoid main() { color = v_Color; }\n";
+
+static void MakeInstances(std::vector<Instance>& instances, float time)
+{
+	unsigned int count = (unsigned int)instances.size();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float x = (float)(i % 317) / 317.0f * 2.0f - 1.0f;
+		float y = (float)(i / 317 % 317) / 317.0f * 2.0f - 1.0f;
+		float angle = time + i * 0.01f;
+		float scale = 0.005f;
+		float c = std::cos(angle) * scale, s = std::sin(angle) * scale;
+		Instance& instance = instances[i];
+		float transform[16] = { c, s, 0, 0,  -s, c, 0, 0,  0, 0, 1, 0,  x, y, 0, 1 };
+		std::copy(transform, transform + 16, instance.Transform);
+		instance.Color[0] = (unsigned char)(i * 37);
+		instance.Color[1] = (unsigned char)(i * 91);
+		instance.Color[2] = (unsigned char)(i * 13);
+		instance.Color[3] = 255;
+	}
+}
+
+int main(void)
+{
+	if (!glfwInit())
+		return -1;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(640, 480, "bench_instancing", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << "Error\n";
+		return -1;
+	}
+	std::cout << glGetString(GL_RENDERER) << std::endl;
+
+	QuadVertex quad[] = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f } };
+	unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+	const unsigned int quadCount = 100000;
+	std::vector<Instance> instances(quadCount);
+	MakeInstances(instances, 0.0f);
+
+	VertexBuffer quadVB{ quad, sizeof(quad) };
+	IndexBuffer ib{ indices, 6 };
+	VertexBuffer instanceVB{ instances.data(), (unsigned int)(quadCount * sizeof(Instance)), BufferUsage::Stream };
+
+	VertexArray uniformVA;
+	uniformVA.AddBuffer<QuadVertex>(quadVB);
+
+	VertexArray instancedVA;
+	instancedVA.AddBuffer<QuadVertex>(quadVB); //location 0
+	instancedVA.AddInstanceBuffer<Instance>(instanceVB); //location 1~4(mat4), 5(color)
+	std::cout << "instanced VAO uses " << instancedVA.GetAttributeCount() << " attribute locations" << std::endl;
+
+	unsigned int uniformProgram = CompileProgram(s_UniformVS, s_UniformFS);
+	unsigned int instancedProgram = CompileProgram(s_InstancedVS, s_InstancedFS);
+	int transformLocation = glGetUniformLocation(uniformProgram, "u_Transform");
+	int colorLocation = glGetUniformLocation(uniformProgram, "u_Color");
+
+	const int frames = 30;
+	double uniformCpuMs = 0.0, uniformMs = 0.0, instancedCpuMs = 0.0, instancedMs = 0.0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool instanced = pass == 1;
+		glFinish();
+		auto start = chrono::steady_clock::now();
+		double cpuMs = 0.0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			MakeInstances(instances, frame * 0.1f);
+			auto submitStart = chrono::steady_clock::now();
+			glClear(GL_COLOR_BUFFER_BIT);
+			if (instanced)
+			{
+				GLState::UseProgram(instancedProgram);
+				instanceVB.Orphan(instances.data(), (unsigned int)(quadCount * sizeof(Instance)));
+				Renderer::DrawInstanced(instancedVA, ib, quadCount);
+			}
+			else
+			{
+				GLState::UseProgram(uniformProgram);
+				for (const Instance& instance : instances)
+				{
+					float color[4] = { instance.Color[0] / 255.0f, instance.Color[1] / 255.0f, instance.Color[2] / 255.0f, 1.0f };
+					glUniformMatrix4fv(transformLocation, 1, GL_FALSE, instance.Transform);
+					glUniform4fv(colorLocation, 1, color);
+					Renderer::Draw(uniformVA, ib);
+				}
+			}
+			cpuMs += chrono::duration<double, milli>(chrono::steady_clock::now() - submitStart).count();
+			glfwSwapBuffers(window);
+		}
+		glFinish();
+		double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		(instanced ? instancedCpuMs : uniformCpuMs) = cpuMs / frames;
+		(instanced ? instancedMs : uniformMs) = totalMs / frames;
+	}
+
+	std::cout << quadCount << " quads" << std::endl;
+	std::cout << "  uniform per draw: submit " << uniformCpuMs << " ms/frame, total " << uniformMs << " ms/frame (" << quadCount << " draw calls)" << std::endl;
+	std::cout << "  instanced:        submit " << instancedCpuMs << " ms/frame, total " << instancedMs << " ms/frame (1 draw call)" << std::endl;
+
+	glDeleteProgram(uniformProgram);
+	glDeleteProgram(instancedProgram);
+	glfwTerminate();
+	return 0;
+}
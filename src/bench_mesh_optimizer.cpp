@@ -0,0 +1,124 @@
+// Benchmark - MeshOptimizer
+// 삼각형과 vertex 순서를 섞은 큰 격자 mesh(구 표면)에 각 단계를 적용하고, 걸린 시간과 ACMR/ATVR/overfetch 변화를 출력
+// 첫 단계는 삼각형마다 vertex를 따로 갖는(import 직후 같은) mesh를 VertexWeld로 합치는 것
+// GL 함수는 호출하지 않으므로 context 없이 실행 가능
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "MeshOptimizer.h"
+#include "VertexWeld.h"
+
+using namespace std;
+
+struct Vertex
+{
+	float Position[3];
+	float Normal[3];
+	float TexCoord[2];
+};
+
+//구를 segments x segments 격자로 나눈 mesh. 작성 순서를 흉내내기 위해 삼각형 순서와 vertex 순서를 무작위로 섞음
+static void MakeSphere(unsigned int segments, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	for (unsigned int y = 0; y <= segments; y++)
+	{
+		for (unsigned int x = 0; x <= segments; x++)
+		{
+			float theta = (float)y / segments * 3.14159265f, phi = (float)x / segments * 6.2831853f;
+			float n[3] = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+			vertices.push_back({ { n[0], n[1], n[2] }, { n[0], n[1], n[2] }, { (float)x / segments, (float)y / segments } });
+		}
+	}
+	for (unsigned int y = 0; y < segments; y++)
+	{
+		for (unsigned int x = 0; x < segments; x++)
+		{
+			unsigned int i0 = y * (segments + 1) + x, i1 = i0 + 1, i2 = i0 + segments + 1, i3 = i2 + 1;
+			unsigned int triangles[] = { i0, i2, i1, i1, i2, i3 };
+			indices.insert(indices.end(), triangles, triangles + 6);
+		}
+	}
+
+	std::mt19937 rng(1234);
+	std::vector<unsigned int> order(indices.size() / 3);
+	for (unsigned int i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), rng);
+	std::vector<unsigned int> shuffled;
+	shuffled.reserve(indices.size());
+	for (unsigned int t : order)
+		shuffled.insert(shuffled.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+	indices.swap(shuffled);
+
+	std::vector<unsigned int> remap(vertices.size());
+	for (unsigned int i = 0; i < remap.size(); i++)
+		remap[i] = i;
+	std::shuffle(remap.begin(), remap.end(), rng);
+	std::vector<Vertex> moved(vertices.size());
+	for (unsigned int i = 0; i < remap.size(); i++)
+		moved[remap[i]] = vertices[i];
+	vertices.swap(moved);
+	for (unsigned int& index : indices)
+		index = remap[index];
+}
+
+int main(void)
+{
+	const unsigned int segmentCounts[] = { 100, 400, 1000 };
+	for (unsigned int segments : segmentCounts)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+		MakeSphere(segments, vertices, indices);
+		std::cout << "sphere " << segments << "x" << segments << ": " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles" << std::endl;
+
+		//index를 풀어서 모서리마다 vertex를 복사한 뒤 다시 합침
+		std::vector<Vertex> expanded(indices.size());
+		for (unsigned int i = 0; i < indices.size(); i++)
+		{
+			expanded[i] = vertices[indices[i]];
+			indices[i] = i;
+		}
+		vertices.swap(expanded);
+
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<float>(3);
+		layout.Push<float>(2);
+		auto start = chrono::steady_clock::now();
+		VertexWeldReport weld = VertexWeld::Weld(indices, vertices.data(), (unsigned int)vertices.size(), layout);
+		double weldMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		vertices.resize(weld.VertexCountAfter);
+		unsigned int vertexCount = weld.VertexCountAfter;
+		std::cout << "  (" << weldMs << " ms) weld: " << weld.VertexCountBefore << " -> " << weld.VertexCountAfter << " vertices, "
+			<< weld.BytesBefore / 1024 << " -> " << weld.BytesAfter / 1024 << " KB (" << weld.Partitions << " partitions, " << weld.Threads << " threads)" << std::endl;
+
+		start = chrono::steady_clock::now();
+		MeshOptimizeReport cache = MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+		double cacheMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+		start = chrono::steady_clock::now();
+		MeshOptimizeReport overdraw = MeshOptimizer::OptimizeOverdraw(indices, vertices[0].Position, sizeof(Vertex), vertexCount);
+		double overdrawMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+		start = chrono::steady_clock::now();
+		MeshOptimizeReport fetch;
+		vertexCount = MeshOptimizer::OptimizeVertexFetch(indices, vertices.data(), vertexCount, sizeof(Vertex), &fetch);
+		double fetchMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+		std::cout << "  (" << cacheMs << " ms) ";
+		MeshOptimizer::PrintReport("vertex cache", cache);
+		std::cout << "  (" << overdrawMs << " ms) ";
+		MeshOptimizer::PrintReport("overdraw", overdraw);
+		std::cout << "  (" << fetchMs << " ms) ";
+		MeshOptimizer::PrintReport("vertex fetch", fetch);
+	}
+	return 0;
+}
@@ -0,0 +1,163 @@
+// Benchmark - ParseShader
+// 기존 getline/stringstream 파서와 파일을 한번에 읽고 memchr로 "#shader"를 찾는 Shader::ParseShader 비교
+// ParseShader는 ShaderSourceCache를 거치므로 파일마다 수정 시간 확인(stat)과, 캐시가 파일 200개의 버퍼를 모두 들고 있는 비용이 포함됨
+// 같은 include 10개를 공유하는 셰이더 200개를 읽을 때 include 파일을 디스크에서 몇번 읽는지도 확인
+// GL 함수는 호출하지 않으므로 context 없이 실행 가능
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include "res/shaders/Shader.h"
+
+using namespace std;
+
+struct LegacyShaderProgramSource
+{
+	std::string VertexSource;
+	std::string FragSource;
+};
+
+//main08.cpp까지 사용하던 파서(비교용으로 그대로 복사)
+static LegacyShaderProgramSource LegacyParseShader(const std::string& filepath)
+{
+	std::ifstream stream(filepath);
+
+	enum class ShaderType
+	{
+		NONE = -1, VERTEX = 0, FRAGMENT = 1
+	};
+
+	std::string line;
+	std::stringstream ss[2];
+	ShaderType type = ShaderType::NONE;
+	while (getline(stream, line))
+	{
+		if (line.find("#shader") != std::string::npos)
+		{
+			if (line.find("vertex") != std::string::npos)
+				type = ShaderType::VERTEX;
+			else if (line.find("fragment") != std::string::npos)
+				type = ShaderType::FRAGMENT;
+		}
+		else
+		{
+			ss[(int)type] << line << '\n';
+		}
+	}
+
+	return { ss[0].str(), ss[1].str() };
+}
+
+//stage마다 lineCount줄짜리 셰이더 파일을 만듦
+static void WriteShaderFile(const std::string& path, int lineCount)
+{
+	std::ofstream stream(path);
+	const char* stages[] = { "vertex", "fragment" };
+	for (const char* stage : stages)
+	{
+		stream << "#shader " << stage << "\n#version 330 core\n\n";
+		for (int i = 0; i < lineCount; i++)
+			stream << "uniform vec4 u_Param" << i << "; // padding padding padding padding\n";
+		stream << "void main()\n{\n}\n\n";
+	}
+}
+
+int main(void)
+{
+	const int fileCount = 200;
+	const int lineCounts[] = { 50, 500, 5000 };
+	const int iterations = 5;
+
+	std::string directory = (std::filesystem::temp_directory_path() / "bench_parse_shader").string();
+	std::filesystem::create_directories(directory);
+
+	for (int lineCount : lineCounts)
+	{
+		std::vector<std::string> paths;
+		for (int i = 0; i < fileCount; i++)
+		{
+			paths.push_back(directory + "/shader" + std::to_string(i) + ".shader");
+			WriteShaderFile(paths.back(), lineCount);
+		}
+
+		size_t legacyBytes = 0, newBytes = 0;
+		double legacyMs = 1e30, newMs = 1e30; //여러번 돌린 중 최소값 사용
+
+		for (int it = 0; it < iterations; it++)
+		{
+			auto start = chrono::steady_clock::now();
+			for (const auto& path : paths)
+			{
+				LegacyShaderProgramSource source = LegacyParseShader(path);
+				legacyBytes += source.VertexSource.size() + source.FragSource.size();
+			}
+			legacyMs = min(legacyMs, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+
+			Shader::GetSourceCache().Clear(); //캐시 적중이 아닌 실제 파싱 시간을 측정
+			start = chrono::steady_clock::now();
+			for (const auto& path : paths)
+			{
+				ShaderProgramSource source = Shader::ParseShader(path);
+				newBytes += source.VertexSource.size() + source.FragSource.size();
+			}
+			newMs = min(newMs, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+		}
+
+		std::cout << fileCount << " files x " << lineCount << " lines/stage: "
+			<< "getline " << legacyMs << " ms, single-pass " << newMs << " ms ("
+			<< legacyMs / newMs << "x), bytes " << legacyBytes / iterations << " / " << newBytes / iterations << std::endl;
+	}
+
+	//공유 include: 모든 셰이더가 같은 파일 10개를 include
+	const int includeCount = 10;
+	for (int i = 0; i < includeCount; i++)
+	{
+		std::ofstream stream(directory + "/common" + std::to_string(i) + ".glsl");
+		for (int line = 0; line < 100; line++)
+			stream << "float common" << i << "_" << line << "(float x) { return x * " << line << ".0; }\n";
+	}
+	std::vector<std::string> paths;
+	for (int i = 0; i < fileCount; i++)
+	{
+		paths.push_back(directory + "/include" + std::to_string(i) + ".shader");
+		std::ofstream stream(paths.back());
+		const char* stages[] = { "vertex", "fragment" };
+		for (const char* stage : stages)
+		{
+			stream << "#shader " << stage << "\n#version 330 core\n";
+			for (int include = 0; include < includeCount; include++)
+				stream << "#include \"common" << include << ".glsl\"\n";
+			stream << "void main()\n{\n}\n\n";
+		}
+	}
+
+	Shader::GetSourceCache().Clear();
+	ShaderSourceCacheStats before = Shader::GetSourceCache().GetStats();
+	auto start = chrono::steady_clock::now();
+	for (const auto& path : paths)
+		Shader::ParseShader(path);
+	double coldMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	ShaderSourceCacheStats cold = Shader::GetSourceCache().GetStats();
+
+	start = chrono::steady_clock::now();
+	for (const auto& path : paths)
+		Shader::ParseShader(path);
+	double warmMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	ShaderSourceCacheStats warm = Shader::GetSourceCache().GetStats();
+
+	std::cout << fileCount << " files x " << includeCount << " shared includes: "
+		<< "first load " << coldMs << " ms (" << cold.FileReads - before.FileReads << " file reads), "
+		<< "second load " << warmMs << " ms (" << warm.FileReads - cold.FileReads << " file reads, "
+		<< warm.ParseHits - cold.ParseHits << " parse hits)" << std::endl;
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,110 @@
+// Benchmark - QuadBatch
+// frame마다 quad 200k개(절반은 색만, 절반은 texture 48개 중 하나)를 QuadBatch로 그리는 시간과 draw call/업로드 양 측정
+//  1. sorted: texture별로 모아서 넣음(dashboard의 같은 위젯끼리 그리는 경우)
+//  2. mixed: quad마다 texture가 바뀜(최악의 경우. slot이 모자랄 때마다 flush)
+// 보이지 않는 창을 만들어 GL context를 얻음. vsync는 끔
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "QuadBatch.h"
+
+using namespace std;
+
+static unsigned int CreateTexture(unsigned int color)
+{
+	unsigned int texture = 0;
+	unsigned int pixels[4 * 4];
+	for (unsigned int& pixel : pixels)
+		pixel = color;
+	glGenTextures(1, &texture);
+	GLState::BindTexture(0, GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	return texture;
+}
+
+int main(void)
+{
+	if (!glfwInit())
+		return -1;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	const int width = 1280, height = 720;
+	GLFWwindow* window = glfwCreateWindow(width, height, "bench_quad_batch", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << "Error\n";
+		return -1;
+	}
+	std::cout << glGetString(GL_RENDERER) << std::endl;
+
+	std::vector<unsigned int> textures;
+	for (unsigned int i = 0; i < 48; i++)
+		textures.push_back(CreateTexture(0xFF000000 | (i * 0x050B13)));
+
+	{ //batch의 GL 객체는 context가 살아있을 때 삭제되어야 함
+		QuadBatch batch;
+		batch.SetViewport((float)width, (float)height);
+		std::cout << "batch: " << batch.GetMaxQuads() << " quads, " << batch.GetTextureSlotCount() << " texture slots" << std::endl;
+
+		const unsigned int quadCount = 200000;
+		const int frames = 60;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			bool mixed = pass == 1;
+			double cpuMs = 0.0;
+			glFinish();
+			auto start = chrono::steady_clock::now();
+			for (int frame = 0; frame < frames; frame++)
+			{
+				auto submitStart = chrono::steady_clock::now();
+				glClear(GL_COLOR_BUFFER_BIT);
+				batch.BeginFrame();
+				for (unsigned int i = 0; i < quadCount; i++)
+				{
+					float x = (float)(i % 400) * 3.2f, y = (float)(i / 400 % 240) * 3.0f;
+					if (i < quadCount / 2)
+						batch.DrawQuad(x, y, 3.0f, 2.5f, 0xFF000000 | i);
+					else
+					{
+						unsigned int t = mixed ? i % textures.size() : (i - quadCount / 2) * (unsigned int)textures.size() / (quadCount / 2);
+						batch.DrawTexturedQuad(x, y, 3.0f, 2.5f, textures[t]);
+					}
+				}
+				batch.Flush();
+				cpuMs += chrono::duration<double, milli>(chrono::steady_clock::now() - submitStart).count();
+				glfwSwapBuffers(window);
+			}
+			glFinish();
+			double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+			std::cout << (mixed ? "mixed textures: " : "sorted textures: ") << "submit " << cpuMs / frames << " ms/frame, total " << totalMs / frames << " ms/frame" << std::endl;
+			std::cout << "  ";
+			batch.PrintFrameStats();
+		}
+	}
+
+	for (unsigned int texture : textures)
+	{
+		GLState::OnDeleteTexture(texture);
+		glDeleteTextures(1, &texture);
+	}
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,102 @@
+// Benchmark - RenderQueue 정렬
+// frame마다 draw packet 100k개(shader 64개, material 1024개, VAO 256개, 10%는 반투명)를 넣고 정렬하는 시간을 측정하고,
+// 넣은 순서 그대로 그릴 때와 정렬한 순서로 그릴 때의 program/VAO/material 변경 수를 비교
+// GL 함수는 호출하지 않으므로(Submit은 하지 않음) context 없이 실행 가능
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "RenderQueue.h"
+
+using namespace std;
+
+struct StateChanges
+{
+	unsigned int Programs = 0;
+	unsigned int VertexArrays = 0;
+	unsigned int Materials = 0;
+};
+
+template<typename GetPacket>
+static StateChanges CountStateChanges(unsigned int count, GetPacket get)
+{
+	StateChanges changes;
+	unsigned int program = 0, vertexArray = 0, material = 0xFFFFFFFF;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const DrawPacket& packet = get(i);
+		changes.Programs += packet.Program != program;
+		changes.VertexArrays += packet.VertexArray != vertexArray;
+		changes.Materials += packet.Material != material;
+		program = packet.Program;
+		vertexArray = packet.VertexArray;
+		material = packet.Material;
+	}
+	return changes;
+}
+
+int main(void)
+{
+	const unsigned int packetCounts[] = { 10000, 100000, 300000 };
+	std::mt19937 rng(42);
+	for (unsigned int packetCount : packetCounts)
+	{
+		//mesh마다 shader/material/VAO가 정해져 있고, frame마다 depth만 바뀌는 상황
+		std::vector<DrawPacket> packets(packetCount);
+		for (DrawPacket& packet : packets)
+		{
+			packet.Program = 1 + rng() % 64;
+			packet.Material = rng() % 1024;
+			packet.VertexArray = 1 + rng() % 256;
+			packet.IndexBuffer = packet.VertexArray;
+			packet.Count = 36;
+			packet.Translucent = rng() % 10 == 0;
+			packet.Pass = packet.Translucent ? 2 : 1;
+		}
+
+		RenderQueue queue;
+		queue.Reserve(packetCount);
+		const int frames = 200;
+		double addMs = 0.0, sortMs = 0.0;
+		std::uniform_real_distribution<float> depth(0.1f, 1000.0f);
+		for (int frame = 0; frame < frames; frame++)
+		{
+			for (DrawPacket& packet : packets)
+				packet.Depth = depth(rng);
+
+			auto start = chrono::steady_clock::now();
+			queue.Clear();
+			for (const DrawPacket& packet : packets)
+				queue.Add(&packet);
+			addMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+			queue.Sort();
+			sortMs += queue.GetStats().SortMs;
+		}
+
+		//정렬 결과 확인
+		bool sorted = true;
+		for (unsigned int i = 1; i < queue.GetCount(); i++)
+			sorted = sorted && queue.GetSortedKey(i - 1) <= queue.GetSortedKey(i);
+
+		//비교: 같은 key를 std::sort로 정렬
+		std::vector<std::pair<uint64_t, uint32_t>> keys(packetCount);
+		for (unsigned int i = 0; i < packetCount; i++)
+			keys[i] = { RenderQueue::MakeKey(packets[i]), i };
+		auto start = chrono::steady_clock::now();
+		std::sort(keys.begin(), keys.end());
+		double stdSortMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+		StateChanges unsortedChanges = CountStateChanges(packetCount, [&](unsigned int i) -> const DrawPacket& { return packets[i]; });
+		StateChanges sortedChanges = CountStateChanges(packetCount, [&](unsigned int i) -> const DrawPacket& { return queue.GetSorted(i); });
+
+		std::cout << packetCount << " packets: add " << addMs / frames << " ms, radix sort " << sortMs / frames << " ms (std::sort "
+			<< stdSortMs << " ms)" << (sorted ? "" : "  NOT SORTED") << std::endl;
+		std::cout << "  state changes (program/VAO/material): submission order " << unsortedChanges.Programs << "/" << unsortedChanges.VertexArrays
+			<< "/" << unsortedChanges.Materials << ", sorted " << sortedChanges.Programs << "/" << sortedChanges.VertexArrays << "/" << sortedChanges.Materials << std::endl;
+	}
+	return 0;
+}
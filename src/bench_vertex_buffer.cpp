@@ -0,0 +1,133 @@
+// Benchmark - VertexBuffer 업데이트 방식
+// 매 frame 버퍼 전체를 새 데이터로 채우고 그 버퍼로 draw할 때, 세 방식의 frame당 시간 비교
+//  1. Update: glBufferSubData로 같은 저장소에 덮어쓰기(이전 frame의 draw가 끝나기를 기다릴 수 있음)
+//  2. Orphan: glBufferData(nullptr)로 저장소를 교체한 뒤 쓰기
+//  3. Stream: 크기가 frame 3개분인 버퍼에 동기화 없이 map해서 이어쓰기
+// 보이지 않는 창을 만들어 GL context를 얻음. vsync는 끔
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "GLState.h"
+#include "VertexBuffer.h"
+
+using namespace std;
+
+static unsigned int CompileProgram()
+{
+	//각 vertex(vec4 16 byte)를 점 하나로 그림. 버퍼 내용을 GPU가 실제로 읽게 하기 위함
+	const char* vs = "#version 330 core\nlayout(location = 0) in vec4 position;\nvoid main() { gl_Position = vec4(position.xy, 0.0, 1.0); gl_PointSize = 1.0; }\n";
+	const char* fs = "#version 330 core\nout vec4 color;\nvoid main() { color = vec4(1.0); }\n";
+
+	unsigned int program = glCreateProgram();
+	const char* sources[] = { vs, fs };
+	unsigned int types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (int i = 0; i < 2; i++)
+	{
+		unsigned int id = glCreateShader(types[i]);
+		glShaderSource(id, 1, &sources[i], nullptr);
+		glCompileShader(id);
+		glAttachShader(program, id);
+		glDeleteShader(id);
+	}
+	glLinkProgram(program);
+	return program;
+}
+
+enum class Strategy
+{
+	Update, Orphan, Stream
+};
+
+static double Run(GLFWwindow* window, Strategy strategy, const std::vector<float>& data, int frames)
+{
+	unsigned int size = (unsigned int)(data.size() * sizeof(float));
+	unsigned int vertexCount = size / 16;
+
+	//Stream은 GPU가 읽는 중인 frame과 겹치지 않도록 여러 frame분의 공간을 잡아둠
+	unsigned int capacity = strategy == Strategy::Stream ? size * 3 : size;
+	VertexBuffer vb{ nullptr, capacity, BufferUsage::Stream };
+
+	unsigned int vao;
+	glGenVertexArrays(1, &vao);
+	GLState::BindVertexArray(vao);
+	vb.Bind();
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 16, nullptr);
+
+	glFinish();
+	auto start = chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		unsigned int first = 0;
+		switch (strategy)
+		{
+			case Strategy::Update: vb.Update(0, data.data(), size); break;
+			case Strategy::Orphan: vb.Orphan(data.data(), size); break;
+			case Strategy::Stream: first = vb.Stream(data.data(), size) / 16; break;
+		}
+		glDrawArrays(GL_POINTS, first, vertexCount);
+		glfwSwapBuffers(window);
+	}
+	glFinish();
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	GLState::OnDeleteVertexArray(vao);
+	glDeleteVertexArrays(1, &vao);
+	return ms / frames;
+}
+
+int main(void)
+{
+	if (!glfwInit())
+		return -1;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "bench_vertex_buffer", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << "Error\n";
+		return -1;
+	}
+	std::cout << glGetString(GL_RENDERER) << std::endl;
+
+	unsigned int program = CompileProgram();
+	GLState::UseProgram(program);
+
+	const unsigned int sizes[] = { 1u << 10, 16u << 10, 256u << 10, 4u << 20, 64u << 20 };
+	for (unsigned int size : sizes)
+	{
+		std::vector<float> data(size / sizeof(float), 0.5f);
+		int frames = std::max(10, (int)std::min<unsigned int>(1000u, (256u << 20) / size)); //큰 버퍼는 frame 수를 줄임
+
+		Run(window, Strategy::Update, data, 5); //warm-up
+		double update = Run(window, Strategy::Update, data, frames);
+		double orphan = Run(window, Strategy::Orphan, data, frames);
+		double stream = Run(window, Strategy::Stream, data, frames);
+
+		std::cout << (size >= (1u << 20) ? size >> 20 : size >> 10) << (size >= (1u << 20) ? " MB" : " KB")
+			<< " x " << frames << " frames: Update " << update << " ms/frame, Orphan " << orphan
+			<< " ms/frame, Stream(unsynchronized map) " << stream << " ms/frame" << std::endl;
+	}
+
+	GLState::OnDeleteProgram(program);
+	glDeleteProgram(program);
+	glfwTerminate();
+	return 0;
+}
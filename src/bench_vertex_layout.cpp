@@ -0,0 +1,209 @@
+// Benchmark - interleaved vs split(SoA) vertex stream
+// position/normal/uv/tangent(48 byte)를 가진 큰 격자 mesh를 두 가지 방식으로 올리고, depth pre-pass와 일반 pass의 frame당 시간 비교
+//  1. Interleaved: 한 버퍼에 48 byte vertex. depth pass도 같은 VAO를 사용(position만 읽어도 cache line에는 나머지가 같이 들어옴)
+//  2. Split: position stream(12 byte) + attribute stream(36 byte). depth pass는 position stream만 붙인 VAO를 사용
+// 같은 격자를 행마다 triangle strip으로 만들고 primitive restart로 이어서 한 번에 그린 경우(index 수 약 1/3)도 비교
+// 보이지 않는 창을 만들어 GL context를 얻음. vsync는 끔. 화면 크기를 작게 해서 vertex fetch가 병목이 되도록 함
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "GLState.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Renderer.h"
+
+using namespace std;
+
+struct Vertex
+{
+	float Position[3];
+	float Normal[3];
+	float TexCoord[2];
+	float Tangent[4];
+};
+DEFINE_VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, Position), VERTEX_ATTRIBUTE(Vertex, Normal),
+	VERTEX_ATTRIBUTE(Vertex, TexCoord), VERTEX_ATTRIBUTE(Vertex, Tangent));
+
+struct PositionVertex
+{
+	float Position[3];
+};
+DEFINE_VERTEX_LAYOUT(PositionVertex, VERTEX_ATTRIBUTE(PositionVertex, Position));
+
+struct AttributeVertex
+{
+	float Normal[3];
+	float TexCoord[2];
+	float Tangent[4];
+};
+DEFINE_VERTEX_LAYOUT(AttributeVertex, VERTEX_ATTRIBUTE(AttributeVertex, Normal), VERTEX_ATTRIBUTE(AttributeVertex, TexCoord),
+	VERTEX_ATTRIBUTE(AttributeVertex, Tangent));
+
+static unsigned int CompileProgram(const char* vs, const char* fs)
+{
+	unsigned int program = glCreateProgram();
+	const char* sources[] = { vs, fs };
+	unsigned int types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (int i = 0; i < 2; i++)
+	{
+		unsigned int id = glCreateShader(types[i]);
+		glShaderSource(id, 1, &sources[i], nullptr);
+		glCompileShader(id);
+		glAttachShader(program, id);
+		glDeleteShader(id);
+	}
+	glLinkProgram(program);
+	return program;
+}
+
+//depth pass: location 0(position)만 사용
+static const char* s_DepthVS = "#version 330 core\nlayout(location = 0) in vec3 position;\nvoid main() { gl_Position = vec4(position, 1.0); }\n";
+static const char* s_DepthFS = "#version 330 core\nvoid main() {}\n";
+//일반 pass: 모든 attribute를 사용
+static const char* s_ShadeVS =
+	"#version 330 core\n"
+	"layout(location = 0) in vec3 position;\nlayout(location = 1) in vec3 normal;\nlayout(location = 2) in vec2 texCoord;\nlayout(location = 3) in vec4 tangent;\n"
+	"out vec4 v_Color;\n"
+	"void main() { gl_Position = vec4(position, 1.0); v_Color = vec4(normal * 0.5 + 0.5, 1.0) * texCoord.x + tangent * 0.1; }\n";
+static const char* s_ShadeFS = "#version 330 core\nin vec4 v_Color;\nout vec4 color;\nvoid main() { color = v_Color; }\n";
+
+static double Run(GLFWwindow* window, const VertexArray& va, const IndexBuffer& ib, unsigned int program, bool depthOnly, int frames,
+	unsigned int mode = GL_TRIANGLES)
+{
+	GLState::UseProgram(program);
+	GLState::ColorMask(!depthOnly, !depthOnly, !depthOnly, !depthOnly);
+	GLState::DepthFunc(depthOnly ? GL_LESS : GL_LEQUAL);
+
+	glFinish();
+	auto start = chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		Renderer::Draw(va, ib, mode); //restart 설정도 ib에 맞춤
+		glfwSwapBuffers(window);
+	}
+	glFinish();
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / frames;
+}
+
+int main(void)
+{
+	if (!glfwInit())
+		return -1;
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "bench_vertex_layout", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << "Error\n";
+		return -1;
+	}
+	std::cout << glGetString(GL_RENDERER) << std::endl;
+	GLState::Enable(GL_DEPTH_TEST);
+
+	unsigned int depthProgram = CompileProgram(s_DepthVS, s_DepthFS);
+	unsigned int shadeProgram = CompileProgram(s_ShadeVS, s_ShadeFS);
+
+	const unsigned int gridSizes[] = { 256, 1024, 2048 };
+	for (unsigned int grid : gridSizes)
+	{
+		//grid x grid vertex 격자(화면을 덮는 물결 모양 면). index는 행 순서이므로 vertex cache 효율은 두 방식이 같음
+		unsigned int vertexCount = grid * grid;
+		std::vector<Vertex> interleaved(vertexCount);
+		std::vector<PositionVertex> positions(vertexCount);
+		std::vector<AttributeVertex> attributes(vertexCount);
+		for (unsigned int y = 0; y < grid; y++)
+		{
+			for (unsigned int x = 0; x < grid; x++)
+			{
+				float u = (float)x / (grid - 1), v = (float)y / (grid - 1);
+				Vertex vertex = { { u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.5f * std::sin(u * 20.0f) * std::cos(v * 20.0f) },
+					{ 0.0f, 0.0f, 1.0f }, { u, v }, { 1.0f, 0.0f, 0.0f, 1.0f } };
+				unsigned int i = y * grid + x;
+				interleaved[i] = vertex;
+				positions[i] = { { vertex.Position[0], vertex.Position[1], vertex.Position[2] } };
+				attributes[i] = { { vertex.Normal[0], vertex.Normal[1], vertex.Normal[2] }, { vertex.TexCoord[0], vertex.TexCoord[1] },
+					{ vertex.Tangent[0], vertex.Tangent[1], vertex.Tangent[2], vertex.Tangent[3] } };
+			}
+		}
+		std::vector<unsigned int> indices;
+		indices.reserve((size_t)(grid - 1) * (grid - 1) * 6);
+		for (unsigned int y = 0; y + 1 < grid; y++)
+		{
+			for (unsigned int x = 0; x + 1 < grid; x++)
+			{
+				unsigned int i0 = y * grid + x, i1 = i0 + 1, i2 = i0 + grid, i3 = i2 + 1;
+				unsigned int triangle[] = { i0, i1, i2, i1, i3, i2 };
+				indices.insert(indices.end(), triangle, triangle + 6);
+			}
+		}
+
+		//행마다 strip 하나: (x, y + 1), (x, y) 순서로 지그재그, 행 끝에 restart 표시(입력 타입의 최대값)
+		std::vector<unsigned int> stripIndices;
+		stripIndices.reserve((size_t)(grid - 1) * (grid * 2 + 1));
+		for (unsigned int y = 0; y + 1 < grid; y++)
+		{
+			for (unsigned int x = 0; x < grid; x++)
+			{
+				stripIndices.push_back((y + 1) * grid + x);
+				stripIndices.push_back(y * grid + x);
+			}
+			stripIndices.push_back(0xFFFFFFFF);
+		}
+
+		VertexBuffer interleavedVB{ interleaved.data(), (unsigned int)(vertexCount * sizeof(Vertex)) };
+		VertexBuffer positionVB{ positions.data(), (unsigned int)(vertexCount * sizeof(PositionVertex)) };
+		VertexBuffer attributeVB{ attributes.data(), (unsigned int)(vertexCount * sizeof(AttributeVertex)) };
+		IndexBuffer ib{ indices.data(), (unsigned int)indices.size() };
+		IndexBuffer stripIB{ stripIndices.data(), (unsigned int)stripIndices.size(), true };
+
+		VertexArray interleavedVA;
+		interleavedVA.AddBuffer<Vertex>(interleavedVB);
+
+		VertexArray depthVA; //position stream만
+		depthVA.AddBuffer<PositionVertex>(positionVB);
+
+		VertexArray splitVA; //position stream(location 0) + attribute stream(location 1~3)
+		splitVA.AddBuffer<PositionVertex>(positionVB, 0);
+		splitVA.AddBuffer<AttributeVertex>(attributeVB, 1);
+
+		int frames = grid >= 2048 ? 20 : 100;
+		Run(window, interleavedVA, ib, depthProgram, true, 5); //warm-up
+
+		double interleavedDepth = Run(window, interleavedVA, ib, depthProgram, true, frames);
+		double splitDepth = Run(window, depthVA, ib, depthProgram, true, frames);
+		double interleavedShade = Run(window, interleavedVA, ib, shadeProgram, false, frames);
+		double splitShade = Run(window, splitVA, ib, shadeProgram, false, frames);
+		double stripShade = Run(window, interleavedVA, stripIB, shadeProgram, false, frames, GL_TRIANGLE_STRIP);
+
+		std::cout << grid << "x" << grid << " (" << vertexCount << " vertices, " << indices.size() / 3 << " triangles)" << std::endl;
+		std::cout << "  depth pre-pass: interleaved " << interleavedDepth << " ms/frame, split(position stream) " << splitDepth << " ms/frame" << std::endl;
+		std::cout << "  full pass:      interleaved " << interleavedShade << " ms/frame, split(2 streams) " << splitShade << " ms/frame" << std::endl;
+		std::cout << "  strip + restart: interleaved " << stripShade << " ms/frame (" << stripIndices.size() << " indices vs " << indices.size() << ")" << std::endl;
+	}
+
+	GLState::OnDeleteProgram(depthProgram);
+	GLState::OnDeleteProgram(shadeProgram);
+	glDeleteProgram(depthProgram);
+	glDeleteProgram(shadeProgram);
+	glfwTerminate();
+	return 0;
+}
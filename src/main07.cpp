@@ -129,39 +129,39 @@ public:
 	{}
 
 	
+	//지원하지 않는 타입이면 컴파일 에러(static_assert(false)는 템플릿이 쓰이지 않아도 에러가 나므로 T에 의존하는 조건 사용)
 	template<typename T>
 	void Push(unsigned int count)
 	{
-		static_assert(false);
-	}
-
-	//template specializations
-	template<>
-	void Push(unsigned int count)
-	void Push<float>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT); //vertex 하나당 float 데이터가 count개 추가될수록, count * size(GL_FLOAT)씩 stride가 커져야 함
-	}
-
-	template<>
-	void Push<unsigned int>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT); //위와 마찬가지
-	}
-
-	template<>
-	void Push<unsigned char>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+		static_assert(sizeof(T) == 0, "unsupported vertex element type");
 	}
 
 	inline const std::vector<VertexBufferElement>& GetElement() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
 };
 
+//template specializations(클래스 안에서는 명시적 특수화를 할 수 없으므로 밖에서 정의)
+template<>
+void VertexBufferLayout::Push<float>(unsigned int count)
+{
+	m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT); //vertex 하나당 float 데이터가 count개 추가될수록, count * size(GL_FLOAT)씩 stride가 커져야 함
+}
+
+template<>
+void VertexBufferLayout::Push<unsigned int>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT); //위와 마찬가지
+}
+
+template<>
+void VertexBufferLayout::Push<unsigned char>(unsigned int count)
+{
+	m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+}
+
 
 
 class VertexArray
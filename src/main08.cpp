@@ -13,300 +13,21 @@
 #include <vector>
 #include <typeinfo>
 
-// #include "res/shaders/Shader.h"
+#include "res/shaders/Shader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "VertexArray.h"
 
 using namespace std;
 
-struct ShaderProgramSource
+//vertex 하나의 데이터. layout(타입/개수/offset/stride)은 아래 매크로로 컴파일 타임에 계산됨
+struct Vertex
 {
-	std::string VertexSource;
-	std::string FragSource;
+	float Position[2];
 };
+DEFINE_VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, Position));
 
-//Layout별로, 데이터를 어떻게 읽어와야 하는지에 대한 정보를 가지고있는 구조체
-struct VertexBufferElement
-{
-	unsigned int type; //각 데이터 타입이 무엇인지 (ex, vertex의 위치면 float)
-	unsigned int count; //데이터가 몇 개인지
-	unsigned char normalized; //데이터의 normalization이 필요한지
-
-	static unsigned int GetSizeOfType(unsigned int type) //타입별로 적절한 메모리 사이즈를 반환하는 static 함수
-	{
-		switch (type)
-		{
-			case GL_FLOAT: return 4;
-			case GL_UNSIGNED_INT: return 4;
-			case GL_UNSIGNED_BYTE: return 1;
-		}
-		assert(0);
-		return 0;
-	}
-};
-
-
-class IndexBuffer
-{
-private:
-	unsigned int m_RendererID;
-	unsigned int m_Count;
-public:
-	IndexBuffer(const unsigned int* data, unsigned int count); //index는 (대부분) unsigned int* 타입. count는 갯수(size와 다름)
-	~IndexBuffer();
-
-	void Bind() const;
-	void Unbind() const;
-
-	inline unsigned int GetCount() const { return m_Count; }
-};
-
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count{count}
-{
-	assert(sizeof(unsigned int) == sizeof(GLuint) && "if false, stop here");
-
-	glGenBuffers(1, &m_RendererID); //1. 버퍼 생성
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //2. 바인딩("작업 상태")
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);  //3. 작업 상태 버퍼에 데이터 전달
-}
-
-IndexBuffer::~IndexBuffer()
-{
-	glDeleteBuffers(1, &m_RendererID);
-}
-
-void IndexBuffer::Bind() const
-{
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //바인딩("작업 상태")
-}
-
-void IndexBuffer::Unbind() const
-{
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); //언바인딩
-}
-
-
-class VertexBuffer
-{
-private:
-	unsigned int m_RendererID;
-public:
-	VertexBuffer(const void* data, unsigned int size); //size는 byte 사이즈, 데이터의 타입은 모르기 때문에 void*로.
-	~VertexBuffer();
-
-	void Bind() const;
-	void Unbind() const;
-};
-
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
-{
-	glGenBuffers(1, &m_RendererID); //1. 버퍼 생성
-	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID); //2. 바인딩("작업 상태")
-	glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);  //3. 작업 상태 버퍼에 데이터 전달
-}
-
-VertexBuffer::~VertexBuffer()
-{
-	glDeleteBuffers(1, &m_RendererID);
-}
-
-void VertexBuffer::Bind() const
-{
-	glBindBuffer(GL_ARRAY_BUFFER, m_RendererID); //바인딩("작업 상태")
-}
-
-void VertexBuffer::Unbind() const
-{
-	glBindBuffer(GL_ARRAY_BUFFER, 0); //언바인딩
-}
-
-
-class VertexBufferLayout
-{
-private:
-	std::vector<VertexBufferElement> m_Elements; //하나의 layout은 여러개의 element를 갖고 있음(ex, position, normal, color, etc...)
-	unsigned int m_Stride; //vertex하나당 데이터가 얼마나 떨어져있는지 stride를 멤버변수로 갖고 있음
-
-public:
-	VertexBufferLayout()
-		: m_Stride{ 0 }
-	{}
-
-	void Push<float>(unsigned int count);
-	
-	// template<typename T>
-	// void Push(unsigned int count)
-	// {
-	// 	static_assert(false);
-	// }
-
-	//template specializations
-	// template<>
-	// void Push(unsigned int count)
-	// void Push<float>(unsigned int count)
-	// {
-	// 	m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-	// 	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT); //vertex 하나당 float 데이터가 count개 추가될수록, count * size(GL_FLOAT)씩 stride가 커져야 함
-	// }
-
-	// template<>
-	// void Push<unsigned int>(unsigned int count)
-	// {
-	// 	m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-	// 	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT); //위와 마찬가지
-	// }
-
-	// template<>
-	// void Push<unsigned char>(unsigned int count)
-	// {
-	// 	m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-	// 	m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
-	// }
-
-	inline const std::vector<VertexBufferElement>& GetElement() const { return m_Elements; }
-	inline unsigned int GetStride() const { return m_Stride; }
-};
-
-	void vertexBufferLayout::Push<float>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT); //vertex 하나당 float 데이터가 count개 추가될수록, count * size(GL_FLOAT)씩 stride가 커져야 함
-	}
-
-
-class VertexArray
-{
-private:
-	unsigned int m_RendererID;
-public:
-	VertexArray();
-	~VertexArray();
-
-	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
-
-	void Bind() const;
-	void Unbind() const;
-};
-
-VertexArray::VertexArray()
-{
-	glGenVertexArrays(1, &m_RendererID); //vao 생성
-	//glBindVertexArray(m_RendererID); //vao 바인딩(="작업 상태") <-- 바인딩은 AddBuffer 직전에 수행하도록 함
-}
-
-VertexArray::~VertexArray()
-{
-	glDeleteVertexArrays(1, &m_RendererID);
-}
-
-void VertexArray::AddBuffer(const VertexBuffer & vb, const VertexBufferLayout & layout)
-{
-	Bind(); //vao를 바인딩
-
-	vb.Bind(); //Vertex Buffer를 바인딩
-
-	const auto& elements = layout.GetElement();
-	unsigned int offset = 0;
-	for (int i=0;i<elements.size();i++)
-	{
-		const auto& element = elements[i];
-		glEnableVertexAttribArray(i); //기존에는 0번만 존재했으나, position/normal/color등 여러 attribute가 생기면, 여러 attribute를 enable해야함
-		glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset); //layout별로 데이터를 어떻게 읽어와야하는지를 element구조체로 가지고 있을 예정. 이를 활용함.
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
-	}
-
-}
-
-void VertexArray::Bind() const
-{
-	glBindVertexArray(m_RendererID);
-}
-
-void VertexArray::Unbind() const
-{
-	glBindVertexArray(0);
-}
-
-
-//셰이더 파일 파싱 함수
-static ShaderProgramSource ParseShader(const std::string& filepath)
-{
-	std::ifstream stream(filepath);
-
-	enum class ShaderType
-	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
-	};
-	
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
-
-	while (getline(stream, line))
-	{
-		if (line.find("#shader") != std::string::npos)
-		{
-			if (line.find("vertex") != std::string::npos) //vertex 셰이더 섹션
-			{
-				type = ShaderType::VERTEX;
-			}
-			else if (line.find("fragment") != std::string::npos) //fragment 셰이더 섹션
-			{
-				type = ShaderType::FRAGMENT;
-			}
-		}
-		else
-		{
-			ss[(int)type] << line << '\n'; //코드를 stringstream에 삽입
-		}
-	}
-
-	return { ss[0].str(), ss[1].str() };
-}
-
-static unsigned int CompileShader(unsigned int type, const std::string& source)
-{
-	unsigned int id = glCreateShader(type); //셰이더 객체 생성(마찬가지)
-	const char* src = source.c_str();
-	glShaderSource(id, 1, &src, nullptr); // 셰이더의 소스 코드 명시
-	glCompileShader(id); // id에 해당하는 셰이더 컴파일
-	
-	// Error Handling(없으면 셰이더 프로그래밍할때 괴롭다...)
-	int result;
-	glGetShaderiv(id, GL_COMPILE_STATUS, &result); //셰이더 프로그램으로부터 컴파일 결과(log)를 얻어옴
-	if (result == GL_FALSE) //컴파일에 실패한 경우
-	{
-		int length;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length); //log의 길이를 얻어옴
-		char* message = (char*)alloca(length * sizeof(char)); //stack에 동적할당
-		glGetShaderInfoLog(id, length, &length, message); //길이만큼 log를 얻어옴
-		std::cout << "셰이더 컴파일 실패! " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
-		std::cout << message << std::endl;
-		glDeleteShader(id); //컴파일 실패한 경우 셰이더 삭제
-		return 0;
-	}
-
-	return id;
-}
-
-//--------Shader 프로그램 생성, 컴파일, 링크----------//
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragShader)
-{
-	unsigned int program = glCreateProgram(); //셰이더 프로그램 객체 생성(int에 저장되는 것은 id)
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader); 
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragShader);
-
-	//컴파일된 셰이더 코드를 program에 추가하고 링크
-	glAttachShader(program, vs);
-	glAttachShader(program, fs);
-	glLinkProgram(program);
-	glValidateProgram(program);
-
-	//셰이더 프로그램을 생성했으므로 vs, fs 개별 프로그램은 더이상 필요 없음
-	glDeleteShader(vs);
-	glDeleteShader(fs);
-
-	return program;
-}
 
 int main(void)
 {
@@ -343,11 +64,11 @@ int main(void)
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 
-	float positions[] = { //사각형을 그리기 위해 2차 수정
-		-0.5f, -0.5f, //0
-		 0.5f, -0.5f, //1
-		 0.5f,  0.5f, //2
-		-0.5f,  0.5f, //3
+	Vertex positions[] = { //사각형을 그리기 위해 2차 수정
+		{ -0.5f, -0.5f }, //0
+		{  0.5f, -0.5f }, //1
+		{  0.5f,  0.5f }, //2
+		{ -0.5f,  0.5f }, //3
 	};
 
 	unsigned int indices[] = { //index buffer를 함께 사용(index는 unsigned 타입임에 유의)
@@ -363,11 +84,10 @@ int main(void)
 
 	//vao 생성 VertexArray가 담당
 	VertexArray va; 
-	VertexBuffer vb{ positions, 4 * 2 * sizeof(float) }; 
-	VertexBufferLayout layout;
-	layout.Push<float>(2); //vertex당 2개의 위치를 표현하는 float 데이터
-	//layout.Push<float>(3); //만일 vertex당 색상을 표현하는 3개의 rgb데이터가 더 있었으면 왼쪽과 같이 추가하면, layout에서 알아서 stride 계산
-	va.AddBuffer(vb, layout);
+	VertexBuffer vb{ positions, 4 * sizeof(Vertex) }; 
+	//layout은 Vertex 구조체에서 컴파일 타임에 계산(vertex당 2개의 위치를 표현하는 float 데이터)
+	//만일 vertex당 색상을 표현하는 3개의 rgb데이터가 더 있었으면 Vertex에 멤버를 추가하고 DEFINE_VERTEX_LAYOUT에도 추가하면 stride는 알아서 계산
+	va.AddBuffer<Vertex>(vb);
 
 	//---------데이터를 전달하는 과정--------//
 	// unsigned int bufferID;
@@ -415,7 +135,8 @@ int main(void)
 
 	Shader shader{ "res/shaders/Basic02.shader" };
 	shader.Bind();
-	shader.SetUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
+	int colorIndex = shader.GetUniformIndex("u_Color"); //매 frame 이름으로 찾지 않도록 handle을 얻어둠
+	shader.SetUniform4f(colorIndex, 0.2f, 0.3f, 0.8f, 1.0f);
 
 	va.Unbind();
 	vb.Unbind();
@@ -446,14 +167,16 @@ int main(void)
 		//실시간으로 데이터를 변경하고 싶다면, 매 frame draw call이 호출되기 이전에 uniform 데이터를 변경해서 전달해주면 됨
 		
 		//1. 셰이더 바인딩, uniform 데이터 전달
-		glUseProgram(shader);
-		glUniform4f(location, r, 0.3f, 0.8f, 1.0f);
+		//값이 바뀌지 않은 uniform은 Shader가 glUniform 호출을 생략함
+		//Bind()는 GLState를 거치므로 이미 bind된 program/VAO/버퍼면 GL을 호출하지 않음(첫 frame 이후로는 모두 생략)
+		shader.Bind();
+		shader.SetUniform4f(colorIndex, r, 0.3f, 0.8f, 1.0f);
 
 		// glBindVertexArray(vao);
 		va.Bind();
 		ib.Bind(); //한 모델이 다른 Material을 사용할 경우 여러 Draw call에 걸쳐 그려지는 경우가 많고, 이러한 경우 index buffer로 모델의 부분을 구분하는 경우가 많음
 
-		glDrawElements(GL_TRIANGLES, 6,	GL_UNSIGNED_INT, nullptr); //Draw call, 강제로 오류를 만들어 보자
+		glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr); //Draw call. index 타입은 IndexBuffer가 고른 타입(이 사각형은 8bit)
 
 		if (r > 1.0f)
 			increment = -0.05f;
@@ -469,7 +192,7 @@ int main(void)
 		glfwPollEvents();
 	}
 
-	glDeleteProgram(shader); //셰이더 삭제
+	// glDeleteProgram(shader); //셰이더 삭제는 Shader 소멸자가 담당
 
 	glfwTerminate();
 	return 0;